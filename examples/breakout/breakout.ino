@@ -7,6 +7,19 @@
 #include "examples/testing/font_12x16_Terminal_Microsoft.hpp"
 #include "enums.hpp"
 
+// Use retained mode (needs 4.3 KB of RAM): drawing goes into RAM, and changes
+// are written to the display progressively at the end of each loop, so even
+// full screen changes don't stall the game.
+// #define RETAINED_MODE
+
+#ifdef RETAINED_MODE
+LC7981::BasicDisplay<LC7981::PinsBus<
+	// EN / CS / DI / RW
+	22,  23,  20,  21,
+	// DB0 to DB7
+	10, 11, 12, 13, 14, 15, 18, 19
+>, LC7981::RetainedMemory<>> display;
+#else
 // Prepare display object using `DisplayByPins` (compile-time pin definition)
 LC7981::DisplayByPins<
 	// EN / CS / DI / RW
@@ -14,6 +27,7 @@ LC7981::DisplayByPins<
 	// DB0 to DB7
 	10, 11, 12, 13, 14, 15, 18, 19
 > display;
+#endif
 
 constexpr uint8_t displayWidth = 240;
 constexpr uint8_t displayHeight = 128;
@@ -567,4 +581,8 @@ void loop()
 	lastUpdate = now;
 
 	updateBall(deltaTime);
+
+	// In retained mode: paddle first, then rest of changes within time budget
+	display.flushRows(paddleY, paddleHeight);
+	display.flush(2000);
 }
@@ -0,0 +1,225 @@
+// Helpers for benchmarking the library, kept in separate file as workaround 
+// for Arduino build process generating broken prototypes for templates.
+
+#pragma once
+
+#include <lc7981.hpp>
+#include <lc7981_write_combiner.hpp>
+
+/// Run given code multiple times, then print time it took in microseconds
+/// and approximated number of CPU cycles.
+template <typename Name, typename Function>
+void benchmark(Name name, Function function, const uint8_t repeats = 10)
+{
+	unsigned long timeStart = micros();
+	for (uint8_t i = 0; i < repeats; i++) {
+		function();
+	}
+	unsigned long timeEnd = micros();
+	Serial.print(name);
+	Serial.print('\t');
+	Serial.print(timeEnd - timeStart);
+	Serial.print("us\t");
+	Serial.print((timeEnd - timeStart) * (F_CPU / 1000000UL));
+	Serial.println(" cycles");
+}
+
+/// Benchmark few basic drawing primitives on given display. Each drawing is
+/// flushed, in case the display is in retained mode (`RetainedMemory`).
+template <class Display>
+void benchmarkPrimitives(Display& display, const void* font)
+{
+	benchmark(F("clear"), [&] {
+		display.clearWhite();
+		display.flush();
+	});
+	benchmark(F("drawBlackFill"), [&] {
+		display.drawBlackFill(3, 5, 200, 100);
+		display.flush();
+	});
+	benchmark(F("drawBlackVerticalLine"), [&] {
+		display.drawBlackVerticalLine(7, 0, 128);
+		display.flush();
+	});
+	benchmark(F("drawTextVertical"), [&] {
+		display.drawTextVertical(3, 5, "The quick brown fox", font);
+		display.flush();
+	});
+	const uint8_t barOffset = static_cast<const LC7981::font_header_t*>(font)->height + 2;
+	uint8_t frame = 0;
+	benchmark(F("drawWidgets"), [&] {
+		// Dashboard-like frame: many small labels and bars changing
+		char text[5];
+		for (uint8_t w = 0; w < 16; w++) {
+			const uint8_t x = 3 + (w % 4) * 59;
+			const uint8_t y = 4 + (w / 4) * 30;
+			const uint8_t value = frame * (w + 3);
+			text[0] = '0' + value / 100;
+			text[1] = '0' + value / 10 % 10;
+			text[2] = '0' + value % 10;
+			text[3] = 0;
+			display.drawTextVertical(x, y, text, font);
+			const uint8_t bar = (frame * 7 + w * 13) % 40;
+			display.drawBlackFill(x, y + barOffset, bar + 1, 5);
+			display.drawWhiteFill(x + bar + 1, y + barOffset, 40 - bar, 5);
+		}
+		display.flush();
+		frame += 1;
+	});
+}
+
+/// Draw few scattered primitives (pixels cloud, shallow, steep and vertical
+/// lines and rectangles) on given target (display or `WriteCombiner`).
+template <class Target>
+void drawScattered(Target& target, const uint8_t kind)
+{
+	for (uint8_t k = 0; k < 16; k++) {
+		const uint8_t x = 5 + k * 13;
+		const uint8_t y = 3 + k * 5;
+		switch (kind) {
+			case 0:
+				for (uint8_t j = 0; j < 12; j++) {
+					target.setPixel(x + j * 5 % 13, y + j % 4, j & 1);
+				}
+				break;
+			case 1:
+				target.drawLine(x, y, x + 35, y + 4, k & 1);
+				break;
+			case 2:
+				target.drawLine(x, y, x + 3, y + 30, k & 1);
+				break;
+			case 3:
+				target.drawLine(x, y, x, y + 30, k & 1);
+				break;
+			case 4:
+				if (k & 1) {
+					target.drawBlackRectangle(x, y, 20, 15);
+				}
+				else {
+					target.drawWhiteRectangle(x, y, 20, 15);
+				}
+				break;
+		}
+	}
+}
+
+/// Checksum of whole display memory, read back from the controller.
+template <class Display>
+uint16_t displayChecksum(Display& display)
+{
+	uint16_t sum = 0;
+	uint8_t data[30];
+	display.setCursorAddress(0);
+	display.readStart();
+	for (uint8_t row = 0; row < 128; row++) {
+		display.readNextBytes(data, sizeof(data));
+		for (uint8_t i = 0; i < sizeof(data); i++) {
+			sum = ((sum << 1) | (sum >> 15)) ^ data[i];
+		}
+	}
+	return sum;
+}
+
+/// Benchmark scattered drawing primitives on given display, drawn directly
+/// and through write-combining stage (`WriteCombiner`). If the bus can read,
+/// results of both ways are compared first.
+template <class Display>
+void benchmarkWriteCombining(Display& display)
+{
+	static const char* const names[] = { "pixels", "shallow lines", "steep lines", "vertical lines", "rectangles" };
+	LC7981::WriteCombiner<Display> combiner(display);
+	if (Display::readCost < 255) {
+		for (uint8_t kind = 0; kind < 5; kind++) {
+			display.clearGray();
+			drawScattered(display, kind);
+			const uint16_t direct = displayChecksum(display);
+			display.clearGray();
+			drawScattered(combiner, kind);
+			combiner.flushWrites();
+			const uint16_t combined = displayChecksum(display);
+			Serial.print(names[kind]);
+			Serial.println(direct == combined ? F(" results match") : F(" results MISMATCH"));
+		}
+	}
+	for (uint8_t kind = 0; kind < 5; kind++) {
+		Serial.print(names[kind]);
+		Serial.print(F(" direct:\t"));
+		benchmark(F(""), [&] {
+			drawScattered(display, kind);
+		});
+		Serial.print(names[kind]);
+		Serial.print(F(" combined:\t"));
+		benchmark(F(""), [&] {
+			drawScattered(combiner, kind);
+			combiner.flushWrites();
+		});
+	}
+}
+
+/// Benchmark fill rate (in pixels per second) of black and gray fills of 
+/// few rectangles: full width, byte aligned and unaligned.
+template <class Display>
+void benchmarkFillRate(Display& display)
+{
+	static const struct { uint8_t x, y, w, h; } rectangles[] = {
+		{ 0, 0, 240, 128 },
+		{ 0, 10, 240, 20 },
+		{ 8, 8, 64, 64 },
+		{ 3, 5, 200, 100 },
+		{ 13, 40, 3, 50 },
+	};
+	display.clearWhite();
+	for (const auto& r : rectangles) {
+		constexpr uint8_t repeats = 10;
+		const unsigned long timeStart = micros();
+		for (uint8_t i = 0; i < repeats; i++) {
+			display.drawBlackFill(r.x, r.y, r.w, r.h);
+			display.drawGrayFill(r.x, r.y, r.w, r.h);
+			display.flush();
+		}
+		const unsigned long time = micros() - timeStart;
+		Serial.print(r.w);
+		Serial.print('x');
+		Serial.print(r.h);
+		Serial.print(F(" at "));
+		Serial.print(r.x);
+		Serial.print('\t');
+		Serial.print(static_cast<unsigned long>(2.0 * repeats * r.w * r.h * 1000000 / time));
+		Serial.println(F(" px/s"));
+	}
+}
+
+/// Benchmark text drawing at unaligned position (few rows of labels over
+/// gray background), keeping the background around the text and opaque
+/// (see `BasicDisplay::setOpaque`).
+template <class Display>
+void benchmarkOpaqueText(Display& display, const void* font)
+{
+	const uint8_t height = static_cast<const LC7981::font_header_t*>(font)->height;
+	const auto drawLabels = [&] {
+		for (uint8_t row = 0; row < 4; row++) {
+			display.drawTextVertical(5, 3 + row * (height + 3), "The quick brown fox", font);
+		}
+		display.flush();
+	};
+	display.clearGray();
+	benchmark(F("drawTextVertical"), drawLabels);
+	display.clearGray();
+	typename Display::OpaqueScope opaque(display);
+	benchmark(F("drawTextVertical opaque"), drawLabels);
+}
+
+/// Small benchmark: clear whole screen 20 times (alternating colors), 
+/// returning time it took in microseconds.
+template <class Display>
+unsigned long benchmarkClears(Display& display)
+{
+	unsigned long timeStart = micros();
+	uint8_t x = 0;
+	while (x++ < 10) {
+		display.clearWhite();
+		display.clearBlack();
+	}
+	unsigned long timeEnd = micros();
+	return timeEnd - timeStart;
+}
@@ -10,6 +10,7 @@
 #include "font_08x16_leggibile.hpp"
 #include "font_06x08_Terminal_Microsoft.hpp"
 #include "font_12x16_Terminal_Microsoft.hpp"
+#include "benchmark.hpp"
 
 // Prepare display object using `DisplayByPins` (compile-time pin definition)
 LC7981::DisplayByPins<
@@ -19,10 +20,94 @@ LC7981::DisplayByPins<
 	10, 11, 12, 13, 14, 15, 18, 19
 > display;
 
+// Prepare display object using `FastDisplayByPins` (pins resolved to ports
+// in compile-time, for known boards only).
+// LC7981::FastDisplayByPins<22, 23, 20, 21, 10, 11, 12, 13, 14, 15, 18, 19> display;
+
 // Prepare display object using example fast I/O specialization (see README).
 // #include "fastio_example.hpp"
 // MyDisplay display;
 
+// Prepare display object using virtual methods for I/O on the same pins,
+// to compare it against the display above using `B` benchmark command.
+// #define BENCHMARK_VIRTUAL_DISPLAY
+#ifdef BENCHMARK_VIRTUAL_DISPLAY
+LC7981::VirtualDisplay<LC7981::PinsBus<
+	// EN / CS / DI / RW
+	22,  23,  20,  21,
+	// DB0 to DB7
+	10, 11, 12, 13, 14, 15, 18, 19
+>> virtualDisplay;
+#endif
+
+// Prepare display object using shift registers (74HC595 for data bus, 
+// 74HC165 for reading) over hardware SPI (MOSI 5, MISO 6, SCK 7), to compare
+// it against the display above using `B` command (panel connected this way).
+// #define BENCHMARK_SHIFT_REGISTER_DISPLAY
+#ifdef BENCHMARK_SHIFT_REGISTER_DISPLAY
+#include <lc7981_shift_register.hpp>
+LC7981::ShiftRegisterDisplay<
+	// LATCH / EN / DI / RW / CS
+	4, 22, 20, 21, 23,
+	// Control lines are pins / OE / LOAD
+	false, 3, 2
+> shiftRegisterDisplay;
+#endif
+
+// Prepare display object polling busy flag instead of fixed delays on the 
+// same pins, to compare it against the display above using `$` command.
+// #define BENCHMARK_BUSY_FLAG_TIMING
+#ifdef BENCHMARK_BUSY_FLAG_TIMING
+LC7981::BasicDisplay<LC7981::PinsBus<
+	// EN / CS / DI / RW
+	22,  23,  20,  21,
+	// DB0 to DB7
+	10, 11, 12, 13, 14, 15, 18, 19,
+	// Chip always selected / IO / timing
+	true, LC7981::ArduinoIO, LC7981::BusyFlagTiming<>
+>> busyFlagDisplay;
+#endif
+
+// Prepare display object keeping shadow copy of display memory (3840 bytes
+// of RAM, for boards with 8 KB or more) on the same pins, so drawing doesn't
+// read from the display, to compare it against the display above using `B`
+// command. Note: repeated drawing of the same content is skipped with it.
+// #define BENCHMARK_SHADOW_MEMORY
+#ifdef BENCHMARK_SHADOW_MEMORY
+LC7981::BasicDisplay<LC7981::PinsBus<
+	// EN / CS / DI / RW
+	22,  23,  20,  21,
+	// DB0 to DB7
+	10, 11, 12, 13, 14, 15, 18, 19
+>, LC7981::ShadowMemory<>> shadowMemoryDisplay;
+#endif
+
+// Prepare display object in retained mode (3840 bytes of RAM for the copy
+// and 480 for dirty bits) on the same pins, drawing into RAM and writing
+// changes by `flush`, to compare it against the display above using `B`.
+// #define BENCHMARK_RETAINED_MEMORY
+#ifdef BENCHMARK_RETAINED_MEMORY
+LC7981::BasicDisplay<LC7981::PinsBus<
+	// EN / CS / DI / RW
+	22,  23,  20,  21,
+	// DB0 to DB7
+	10, 11, 12, 13, 14, 15, 18, 19
+>, LC7981::RetainedMemory<>> retainedMemoryDisplay;
+#endif
+
+// Prepare display object caching few rows of display memory (about 300 bytes
+// of RAM) on the same pins, to compare it against the display above using `B`
+// command, which also prints the cache hits and misses.
+// #define BENCHMARK_ROW_CACHE
+#ifdef BENCHMARK_ROW_CACHE
+LC7981::BasicDisplay<LC7981::PinsBus<
+	// EN / CS / DI / RW
+	22,  23,  20,  21,
+	// DB0 to DB7
+	10, 11, 12, 13, 14, 15, 18, 19
+>, LC7981::RowCacheMemory<8>> rowCacheDisplay;
+#endif
+
 // #define DEFAULT_FONT font_08x16_leggibile
 #define DEFAULT_FONT font_06x08_Terminal_Microsoft
 // #define DEFAULT_FONT font_12x16_Terminal_Microsoft
@@ -378,14 +463,75 @@ void loop()
 			}
 			// Small benchmark: Clear and draw whole screen 10 times
 			case '$': {
-				unsigned long timeStart = micros();
-				uint8_t x = 0;
-				while (x++ < 10) {
-					display.clearWhite();
-					display.clearBlack();
-				}
-				unsigned long timeEnd = micros();
-				Serial.println(timeEnd - timeStart);
+				Serial.println(benchmarkClears(display));
+#ifdef BENCHMARK_BUSY_FLAG_TIMING
+				Serial.println(F("busy flag timing:"));
+				busyFlagDisplay.initGraphicMode();
+				Serial.println(benchmarkClears(busyFlagDisplay));
+				display.initGraphicMode();
+#endif
+				break;
+			}
+			// Benchmark of few drawing primitives (10 times each), including
+			// comparison against virtual I/O if enabled.
+			case 'B': {
+				benchmarkPrimitives(display, DEFAULT_FONT);
+#ifdef BENCHMARK_VIRTUAL_DISPLAY
+				Serial.println(F("virtual:"));
+				virtualDisplay.initGraphicMode();
+				benchmarkPrimitives(virtualDisplay, DEFAULT_FONT);
+				display.initGraphicMode();
+#endif
+#ifdef BENCHMARK_SHIFT_REGISTER_DISPLAY
+				Serial.println(F("shift register:"));
+				shiftRegisterDisplay.initGraphicMode();
+				benchmarkPrimitives(shiftRegisterDisplay, DEFAULT_FONT);
+				display.initGraphicMode();
+#endif
+#ifdef BENCHMARK_SHADOW_MEMORY
+				Serial.println(F("shadow memory:"));
+				shadowMemoryDisplay.initGraphicMode();
+				benchmarkPrimitives(shadowMemoryDisplay, DEFAULT_FONT);
+				display.initGraphicMode();
+#endif
+#ifdef BENCHMARK_RETAINED_MEMORY
+				Serial.println(F("retained memory:"));
+				retainedMemoryDisplay.initGraphicMode();
+				benchmarkPrimitives(retainedMemoryDisplay, DEFAULT_FONT);
+				display.initGraphicMode();
+#endif
+#ifdef BENCHMARK_ROW_CACHE
+				Serial.println(F("row cache:"));
+				rowCacheDisplay.initGraphicMode();
+				rowCacheDisplay.memory().resetCounters();
+				benchmarkPrimitives(rowCacheDisplay, DEFAULT_FONT);
+				Serial.print(F("cache hits "));
+				Serial.print(rowCacheDisplay.memory().hits);
+				Serial.print(F(" misses "));
+				Serial.println(rowCacheDisplay.memory().misses);
+				display.initGraphicMode();
+#endif
+				break;
+			}
+
+			// Benchmark of scattered drawing primitives (10 times each), 
+			// directly and through write-combining stage, after checking 
+			// both ways give the same results (if the bus can read).
+			case 'W': {
+				benchmarkWriteCombining(display);
+				break;
+			}
+
+			// Benchmark of fill rate (pixels per second) for few rectangles.
+			case 'F': {
+				benchmarkFillRate(display);
+				break;
+			}
+
+			// Benchmark of text drawing at unaligned position (10 times), 
+			// keeping background and opaque.
+			case 'O': {
+				benchmarkOpaqueText(display, DEFAULT_FONT);
 				break;
 			}
 
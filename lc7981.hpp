@@ -1,6 +1,9 @@
 #pragma once
 
 #include <Arduino.h>
+#ifdef __AVR__
+#include <util/delay_basic.h>
+#endif
 
 namespace LC7981
 {
@@ -15,36 +18,516 @@ enum register_t {
 	Command = 1	// RS = HIGH 
 };
 
-/// Display class base. The other class should be extend it providing basic IO.
-class DisplayBase
+/// Number of CPU cycles (rounded up) taking at least given time in nanoseconds.
+constexpr uint32_t nanosecondsToCycles(const uint32_t nanoseconds)
+{
+	return (nanoseconds * (F_CPU / 1000UL) + 999999UL) / 1000000UL;
+}
+
+/// Wait at least given time in nanoseconds, as exact number of CPU cycles
+/// derived from `F_CPU`, minus cycles already spent by surrounding code 
+/// (like instruction changing the pin state).
+template <uint32_t nanoseconds, uint8_t spentCycles = 0>
+inline void delayNanoseconds()
+{
+	constexpr uint32_t cycles = nanosecondsToCycles(nanoseconds);
+	constexpr uint32_t remaining = cycles > spentCycles ? cycles - spentCycles : 0;
+	if (remaining) {
+#ifdef __AVR__
+		__builtin_avr_delay_cycles(remaining);
+#else
+		delayMicroseconds(1);
+#endif
+	}
+}
+
+/// Bus timing level using datasheet delays. Lower levels use proportionally
+/// shorter delays, down to no delays for level 0 (see `calibrateTiming`).
+constexpr uint8_t fullTimingLevel = 8;
+
+/// Size of buffer (allocated on stack) used to collect bytes before writing
+/// them at once to the bus, for example while drawing text.
+#ifndef LC7981_WRITE_BUFFER_SIZE
+#define LC7981_WRITE_BUFFER_SIZE 16
+#endif
+
+/// Number of rows for which uniform background is tracked (two bits each),
+/// so partial bytes drawn over cleared rows need no reading. Set to 0 to 
+/// save the RAM.
+#ifndef LC7981_BACKGROUND_HINTS
+#define LC7981_BACKGROUND_HINTS 128
+#endif
+
+/// Bus using virtual methods to provide IO, allowing to select or replace the
+/// IO at runtime. Used by `DisplayBase`, for compatibility and flexibility.
+class VirtualBus
 {
-	/* Virtual methods to be provided by specialized class, to allow custom IO. */
+public:
+	/// Relative costs of bus accesses (see `BusBase`).
+	static constexpr uint8_t writeCost = 1;
+	static constexpr uint8_t registerCost = 2;
+	static constexpr uint8_t readCost = 2;
+
 protected:
 	/// Write byte to register.
-	virtual void write(const register_t reg, const uint8_t val);
+	virtual void write(const register_t reg, const uint8_t val) = 0;
 
 	/// Read byte from register.
-	virtual uint8_t read(const register_t reg);
+	virtual uint8_t read(const register_t reg) = 0;
 
 	/// Prepare display to receiving commands and data.
-	virtual void init();
+	virtual void init() = 0;
+
+	/// Write multiple bytes to data register.
+	virtual void writeBytes(const uint8_t* data, uint16_t length)
+	{
+		while (length--) {
+			write(Data, *data++);
+		}
+	}
+
+	/// Write the same byte multiple times to data register.
+	virtual void writeRepeat(const uint8_t value, uint16_t count)
+	{
+		while (count--) {
+			write(Data, value);
+		}
+	}
+
+	/// Read multiple bytes from data register.
+	virtual void readBytes(uint8_t* data, uint16_t length)
+	{
+		while (length--) {
+			*data++ = read(Data);
+		}
+	}
+
+	/// Write instruction followed by its parameter, allowing bus to keep the
+	/// chip selected and data bus set up for both.
+	virtual void writeRegister(const uint8_t instruction, const uint8_t value)
+	{
+		write(Command, instruction);
+		write(Data, value);
+	}
+
+	/// Begin burst of data register writes (after write data command), 
+	/// allowing bus to keep the chip selected and control lines set.
+	virtual void beginWriteBurst() {}
+
+	/// End burst of data register writes, allowing bus to release the chip.
+	virtual void endWriteBurst() {}
+
+	/// Set timing level (see `fullTimingLevel`), if supported by the bus.
+	virtual bool setTimingLevel(const uint8_t /*level*/)
+	{
+		return false;
+	}
+};
+
+/// Base for bus classes, providing default implementations of bulk methods
+/// by looping over the `write` and `read` methods of the bus (`Derived`).
+/// Bus can provide own implementations, to avoid repeating setup of the IO
+/// (like selecting chip or control lines) for each byte.
+template <class Derived>
+class BusBase
+{
+public:
+	/* Relative costs of bus accesses, in about data write units, used by 
+	   the display to choose cheapest way of changing partial bytes (see 
+	   `BasicDisplay::bitOperationsLimit`). Bus can declare own costs. */
+	/// Cost of writing data or command byte.
+	static constexpr uint8_t writeCost = 1;
+	/// Cost of writing instruction with its parameter (`writeRegister`).
+	static constexpr uint8_t registerCost = 2;
+	/// Cost of reading byte, including switching data bus direction.
+	static constexpr uint8_t readCost = 2;
+
+	/// Whether the bus polls busy flag before accesses (see `SharedBus`).
+	static constexpr bool pollBusy = false;
+
+	/// Write multiple bytes to data register.
+	inline void writeBytes(const uint8_t* data, uint16_t length)
+	{
+		while (length--) {
+			derived().write(Data, *data++);
+		}
+	}
+
+	/// Write the same byte multiple times to data register.
+	inline void writeRepeat(const uint8_t value, uint16_t count)
+	{
+		while (count--) {
+			derived().write(Data, value);
+		}
+	}
+
+	/// Read multiple bytes from data register.
+	inline void readBytes(uint8_t* data, uint16_t length)
+	{
+		while (length--) {
+			*data++ = derived().read(Data);
+		}
+	}
+
+	/// Write instruction followed by its parameter, allowing bus to keep the
+	/// chip selected and data bus set up for both.
+	inline void writeRegister(const uint8_t instruction, const uint8_t value)
+	{
+		derived().write(Command, instruction);
+		derived().write(Data, value);
+	}
+
+	/// Begin burst of data register writes (after write data command), 
+	/// allowing bus to keep the chip selected and control lines set.
+	inline void beginWriteBurst() {}
+
+	/// End burst of data register writes, allowing bus to release the chip.
+	inline void endWriteBurst() {}
+
+	/// Set timing level (see `fullTimingLevel`), if supported by the bus.
+	inline bool setTimingLevel(const uint8_t /*level*/)
+	{
+		return false;
+	}
+
+private:
+	inline Derived& derived()
+	{
+		return *static_cast<Derived*>(this);
+	}
+};
+
+/// Display memory policy without shadow copy (default), costing nothing.
+struct NoShadowMemory
+{
+	static constexpr bool enabled = false;
+	static constexpr uint16_t size = 0;
+	static constexpr bool cached = false;
+
+	inline uint8_t shadowRead(const uint16_t /*address*/) const { return 0; }
+	inline void shadowWrite(const uint16_t /*address*/, const uint8_t /*value*/) {}
+	inline const uint8_t* shadowBytes(const uint16_t /*address*/) const { return nullptr; }
+	inline void shadowClear() {}
+	inline uint16_t shadowPosition() const { return 0; }
+	inline void setShadowPosition(const uint16_t /*address*/) {}
+
+	inline bool cacheLoad(const uint16_t /*address*/, uint8_t& /*value*/) { return false; }
+	inline void cacheFill(const uint16_t /*address*/, const uint8_t /*value*/) {}
+	template <typename Value>
+	inline void cacheStore(const uint16_t /*address*/, const uint16_t /*length*/, Value /*value*/) {}
+	inline void cacheBit(const uint16_t /*address*/, const uint8_t /*which*/, const bool /*black*/) {}
+	inline void cacheClear() {}
+
+	static constexpr bool retained = false;
+	inline void markDirty(const uint16_t /*address*/) {}
+	inline uint16_t nextDirty(const uint16_t /*address*/) const { return 0xFFFF; }
+	inline void markClean() {}
+	inline void markClean(const uint16_t /*address*/, const uint16_t /*length*/) {}
+	inline uint16_t flushPosition() const { return 0; }
+	inline void setFlushPosition(const uint16_t /*address*/) {}
+};
+
+/// Display memory policy keeping shadow copy of display memory in RAM 
+/// (`bytes` long, 3840 for 240x128), so drawing never reads the controller
+/// and writes of bytes not changed are skipped. Memory after the copy (like
+/// used by timing calibration) is accessed directly.
+template <uint16_t bytes = 240 / 8 * 128>
+struct ShadowMemory : NoShadowMemory
+{
+	static constexpr bool enabled = true;
+	static constexpr uint16_t size = bytes;
+
+	/// Copy of display memory.
+	uint8_t shadow[bytes];
+	/// Position of next access, as moving cursor is deferred until needed.
+	uint16_t position = 0;
+
+	inline uint8_t shadowRead(const uint16_t address) const { return shadow[address]; }
+	inline void shadowWrite(const uint16_t address, const uint8_t value) { shadow[address] = value; }
+	inline const uint8_t* shadowBytes(const uint16_t address) const { return shadow + address; }
+	inline void shadowClear() { memset(shadow, 0, bytes); }
+	inline uint16_t shadowPosition() const { return position; }
+	inline void setShadowPosition(const uint16_t address) { position = address; }
+};
+
+/// Display memory policy for retained mode: drawing only changes shadow
+/// copy of display memory in RAM (see `ShadowMemory`), marking changed
+/// bytes dirty, and `flush` writes them to the controller in as few bursts
+/// as possible. Takes `bytes` and 1/8 of it more for dirty bits.
+template <uint16_t bytes = 240 / 8 * 128>
+struct RetainedMemory : ShadowMemory<bytes>
+{
+	static constexpr bool retained = true;
+
+	/// Bits of bytes changed since last flush.
+	uint8_t dirty[(bytes + 7) / 8];
+
+	RetainedMemory()
+	{
+		markClean();
+	}
+
+	inline void shadowClear()
+	{
+		ShadowMemory<bytes>::shadowClear();
+		markClean();
+	}
+
+	inline void markDirty(const uint16_t address)
+	{
+		dirty[address / 8] |= 1 << (address % 8);
+	}
+	/// Find first dirty byte at given address or after it, returning `bytes`
+	/// if there is none.
+	uint16_t nextDirty(uint16_t address) const
+	{
+		while (address < bytes) {
+			uint8_t bits = dirty[address / 8] >> (address % 8);
+			if (bits) {
+				while (!(bits & 1)) {
+					bits >>= 1;
+					address += 1;
+				}
+				return address;
+			}
+			address = (address | 7) + 1;
+		}
+		return bytes;
+	}
+	inline void markClean()
+	{
+		memset(dirty, 0, sizeof(dirty));
+	}
+	void markClean(uint16_t address, uint16_t length)
+	{
+		while (length && address % 8) {
+			dirty[address / 8] &= ~(1 << (address % 8));
+			address += 1;
+			length -= 1;
+		}
+		while (length >= 8) {
+			dirty[address / 8] = 0;
+			address += 8;
+			length -= 8;
+		}
+		while (length) {
+			dirty[address / 8] &= ~(1 << (address % 8));
+			address += 1;
+			length -= 1;
+		}
+	}
+
+	/// Address where time-budgeted flush stopped, to continue from there.
+	uint16_t flushStop = 0;
+	inline uint16_t flushPosition() const { return flushStop; }
+	inline void setFlushPosition(const uint16_t address) { flushStop = address; }
+};
+
+/// Display memory policy caching few rows of display memory (`rowBytes`
+/// long, display row of 240 wide display) in RAM, for boards without RAM
+/// for `ShadowMemory` (about 37 bytes per row). Bytes read for drawing at
+/// unaligned positions are cached, so drawing at the same rows again (like
+/// status line, text label or bricks in breakout) doesn't read them from 
+/// the controller. Writes go to the controller, updating cached bytes. Bytes
+/// are cached separately (only bytes actually read or written are valid),
+/// and least recently used row is evicted on miss. Counters of reads served
+/// from the cache and read from the controller help to choose `rows`.
+template <uint8_t rows = 4, uint8_t rowBytes = 240 / 8>
+struct RowCacheMemory : NoShadowMemory
+{
+	static_assert(rows >= 1, "Row cache needs at least one row.");
+	static_assert(rowBytes >= 1 && rowBytes <= 32, "Row cache rows need to be 1 to 32 bytes long.");
+
+	static constexpr bool cached = true;
+
+	/// Number of reads served from the cache.
+	uint32_t hits = 0;
+	/// Number of reads from the controller.
+	uint32_t misses = 0;
+
+	/// Row index marking unused line.
+	static constexpr uint16_t noRow = 0xFFFF;
+
+	struct Line
+	{
+		/// Index of cached row (address divided by `rowBytes`).
+		uint16_t row;
+		/// Bit mask of valid bytes.
+		uint32_t valid;
+		uint8_t data[rowBytes];
+	};
+	Line lines[rows];
+	/// Indexes of lines, most recently used first.
+	uint8_t recency[rows];
+
+	RowCacheMemory()
+	{
+		for (uint8_t i = 0; i < rows; i++) {
+			recency[i] = i;
+		}
+		cacheClear();
+	}
+
+	/// Mark line as most recently used.
+	void touch(const uint8_t index)
+	{
+		uint8_t i = 0;
+		while (recency[i] != index) {
+			i++;
+		}
+		while (i) {
+			recency[i] = recency[i - 1];
+			i--;
+		}
+		recency[0] = index;
+	}
+
+	/// Find line caching given row, or return `rows` if there is none.
+	inline uint8_t find(const uint16_t row) const
+	{
+		uint8_t i = 0;
+		while (i < rows && lines[i].row != row) {
+			i++;
+		}
+		return i;
+	}
+
+	/// Get byte at given address from the cache, if it is valid there.
+	bool cacheLoad(const uint16_t address, uint8_t& value)
+	{
+		const uint8_t index = find(address / rowBytes);
+		const uint8_t column = address % rowBytes;
+		if (index < rows && (lines[index].valid & (1UL << column))) {
+			touch(index);
+			value = lines[index].data[column];
+			hits += 1;
+			return true;
+		}
+		misses += 1;
+		return false;
+	}
+
+	/// Put byte read from the controller into the cache, evicting least
+	/// recently used row if its row is not cached.
+	void cacheFill(const uint16_t address, const uint8_t value)
+	{
+		const uint16_t row = address / rowBytes;
+		const uint8_t column = address % rowBytes;
+		uint8_t index = find(row);
+		if (index == rows) {
+			index = recency[rows - 1];
+			lines[index].row = row;
+			lines[index].valid = 0;
+		}
+		touch(index);
+		lines[index].data[column] = value;
+		lines[index].valid |= 1UL << column;
+	}
+
+	/// Update cached bytes of written range (with `value` for index).
+	template <typename Value>
+	void cacheStore(const uint16_t address, const uint16_t length, Value value)
+	{
+		for (Line& line : lines) {
+			if (line.row == noRow) {
+				continue;
+			}
+			const uint16_t rowStart = line.row * rowBytes;
+			if (address >= rowStart + rowBytes || address + length <= rowStart) {
+				continue;
+			}
+			const uint16_t start = address > rowStart ? address : rowStart;
+			const uint16_t end = address + length < rowStart + rowBytes ? address + length : rowStart + rowBytes;
+			for (uint16_t i = start; i < end; i++) {
+				line.data[i - rowStart] = value(i - address);
+				line.valid |= 1UL << (i - rowStart);
+			}
+		}
+	}
+
+	/// Update cached byte for bit operation.
+	void cacheBit(const uint16_t address, const uint8_t which, const bool black)
+	{
+		const uint8_t index = find(address / rowBytes);
+		if (index < rows) {
+			uint8_t& data = lines[index].data[address % rowBytes];
+			data = black ? (data | (1 << which)) : (data & ~(1 << which));
+		}
+	}
+
+	/// Forget all cached rows.
+	void cacheClear()
+	{
+		for (Line& line : lines) {
+			line.row = noRow;
+		}
+	}
+
+	/// Reset hit and miss counters.
+	inline void resetCounters()
+	{
+		hits = 0;
+		misses = 0;
+	}
+};
+
+/// Display class template, providing all the features over IO provided by 
+/// the bus class, which is extended. The bus is required to provide (at least
+/// protected) `write`, `read` and `init` methods, bulk methods (`writeBytes`,
+/// `writeRepeat` and `readBytes`), `writeRegister` (instruction with its
+/// parameter), burst methods and `setTimingLevel`, in the
+/// same manner as `VirtualBus` does. 
+/// Extend `BusBase` to get default bulk methods. As the methods are resolved 
+/// in compile-time, they can be inlined into the drawing loops, avoiding 
+/// indirect call for each byte.
+/// The `Memory` policy allows to keep shadow copy of display memory (see 
+/// `ShadowMemory`), draw in retained mode (see `RetainedMemory`) or cache 
+/// few rows of it (see `RowCacheMemory`), costing nothing by default 
+/// (`NoShadowMemory`).
+template <class Bus, class Memory = NoShadowMemory>
+class BasicDisplay : public Bus, protected Memory
+{
+	/* Bus methods */
+protected:
+	using Bus::write;
+	using Bus::read;
+	using Bus::init;
+	using Bus::writeBytes;
+	using Bus::writeRepeat;
+	using Bus::readBytes;
+	using Bus::writeRegister;
+	using Bus::beginWriteBurst;
+	using Bus::endWriteBurst;
+public:
+	using Bus::setTimingLevel;
 
 
 
 	/* Fancier way of accessing write/read methods */
-	/// Write byte to register.
+	/// Write byte to register. Writing command ends writing (data burst).
 	template <register_t reg>
 	inline void write(const uint8_t val)
 	{
+		if (reg == Command) {
+			writeEnd();
+		}
 		this->write(reg, val);
 	}
 
-	/// Read byte from register.
+	/// Read byte from register. Reading ends writing (data burst).
 	template <register_t reg>
 	inline uint8_t read()
 	{
+		writeEnd();
 		return this->read(reg);
 	}
+
+	/// Write instruction with its parameter. Ends writing (data burst).
+	inline void writeInstruction(const uint8_t instruction, const uint8_t value)
+	{
+		writeEnd();
+		this->writeRegister(instruction, value);
+	}
 	
 
 
@@ -53,658 +536,2412 @@ protected:
 public:
 	const uint8_t width;
 	const uint8_t height;
+	/// Whether reading single bytes is served from shadow copy in RAM (see
+	/// `ShadowMemory`), so it is cheaper than reading from the controller.
+	static constexpr bool shadowed = Memory::enabled;
 protected:
 	struct {
 		/// Flag to keep track of dummy read required for reading data after moving cursor.
 		bool needDummyRead : 1;
+		/// Flag to keep track of writing (data burst) being started.
+		bool writing : 1;
+		/// Flag whether `cursor` models the controller cursor.
+		bool cursorKnown : 1;
+		/// Flag whether any row has background hint.
+		bool anyBackground : 1;
+		/// Flag of opaque drawing (see `setOpaque`).
+		bool opaqueDrawing : 1;
 	};
+	/// Modelled controller cursor, moved by data writes, bit operations and
+	/// reads (including dummy read), if `cursorKnown`.
+	uint16_t cursor;
+
+	/// Number of rows with background hints (none with shadow memory, as 
+	/// reading is free then).
+	static constexpr uint8_t backgroundHints = Memory::enabled ? 0 : LC7981_BACKGROUND_HINTS;
+	/// Background hints for rows, two bits for each (see `hintUnknown`).
+	uint8_t backgroundRows[backgroundHints ? (backgroundHints + 3) / 4 : 1];
+	/// Bytes even and odd rows were cleared with (see `hintCleared`).
+	uint8_t clearedPattern[2];
+	/// Background byte for opaque drawing (see `setOpaque`).
+	uint8_t opaqueByte;
+	/// Address where current writing (data burst) started, to forget 
+	/// background of written rows, or `noAddress` if not known.
+	uint16_t writtenFrom;
 
 
 
 	/* Initializers */
 public:
 	/// Constructor
-	DisplayBase(uint8_t width, uint8_t height) 
+	BasicDisplay(uint8_t width, uint8_t height) 
 		: width(width), height(height)
-	{}
-	DisplayBase() : DisplayBase(240, 128) {}
+	{
+		needDummyRead = true;
+		writing = false;
+		cursorKnown = false;
+		cursor = 0;
+		anyBackground = false;
+		memset(backgroundRows, 0, sizeof(backgroundRows));
+		clearedPattern[0] = clearedPattern[1] = 0;
+		writtenFrom = noAddress;
+		opaqueDrawing = false;
+		opaqueByte = 0;
+	}
+	BasicDisplay() : BasicDisplay(240, 128) {}
 
 	/// Prepare display to use graphical mode.
 	void initGraphicMode()
 	{
 		// Prepare display to receiving commands and data
 		this->init();
+		invalidateCursor();
+
+		writeGraphicModeRegisters();
+
+		if (Memory::enabled) {
+			// Shadow copy needs to match display memory
+			moveCursor(0);
+			beginWriting();
+			this->writeRepeat(0, Memory::size);
+			cursor += Memory::size;
+			writeEnd();
+			this->shadowClear();
+			this->setShadowPosition(0);
+		}
+	}
 
+protected:
+	/// Write registers setting up graphical mode.
+	void writeGraphicModeRegisters()
+	{
 		// Set mode register to display ON, master mode, graphic mode
-		write<Command>(0b0000);
-		write<Data>(0b00110010);
+		writeInstruction(0b0000, 0b00110010);
 
 		// Set chars/bits per pixel to use 8 bits of 1 byte to display 8 dots
-		write<Command>(0b0001);
-		write<Data>(0b00000111);
+		writeInstruction(0b0001, 0b00000111);
 
 		// Set width of the screen
-		write<Command>(0b0010);
-		write<Data>(width / 8 - 1);
+		writeInstruction(0b0010, width / 8 - 1);
 
 		// Set display duty to max
-		write<Command>(0b0011);
-		write<Data>(127);
+		writeInstruction(0b0011, 127);
 
 		// Set display start lower address
-		write<Command>(0b1000);
-		write<Data>(0);
+		writeInstruction(0b1000, 0);
 
 		// Set display start upper address
-		write<Command>(0b1001);
-		write<Data>(0);
+		writeInstruction(0b1001, 0);
 	}
 
-
-
-	/* Basic methods */
 public:
-	/// Move data read/write cursor to address inside display.
-	void setCursorAddress(uint16_t address)
+	/// Calibrate bus timing (opt-in, if supported by the bus), by writing and
+	/// reading back test patterns in memory after visible area, with shorter
+	/// delays level by level. Fastest reliable level, increased by safety 
+	/// margin, is kept set. Returns the level (see `fullTimingLevel`).
+	/// Registers are written again after, in case failed access hit them.
+	uint8_t calibrateTiming(const uint8_t margin = 2)
 	{
-		write<Command>(0b1010); // Set cursor lower address
-		write<Data>(address & 0xff);
-		write<Command>(0b1011); // Set cursor upper address
-		write<Data>(address >> 8);
-		needDummyRead = true;
+		uint8_t reliable = fullTimingLevel;
+		for (uint8_t level = fullTimingLevel; ; level--) {
+			if (!this->setTimingLevel(level)) {
+				return fullTimingLevel;
+			}
+			if (!testTiming(level)) {
+				break;
+			}
+			reliable = level;
+			if (level == 0) {
+				break;
+			}
+		}
+		reliable = (reliable + margin < fullTimingLevel) ? reliable + margin : fullTimingLevel;
+		this->setTimingLevel(reliable);
+		writeGraphicModeRegisters();
+		return reliable;
 	}
 
-	/// Start writing.
-	inline void writeStart()
-	{
-		write<Command>(0b1100); // Write display data
-	}
-	/// Write next byte (after writing started).
-	inline void writeNextByte(uint8_t value)
-	{
-		write<Data>(value);
-	}
-	/// Write single byte.
-	inline void writeSingleByte(uint8_t value)
+protected:
+	/// Write test pattern after visible area and check it reads back the same.
+	bool testTiming(const uint8_t seed)
 	{
+		constexpr uint8_t length = 16;
+		const uint16_t address = width / 8 * height;
+		uint8_t pattern[length];
+		uint8_t readBack[length];
+		// Accesses with too short delays might have moved the cursor
+		invalidateCursor();
+		for (uint8_t i = 0; i < length; i++) {
+			pattern[i] = (i & 1 ? 0b10101010 : 0b01010101) ^ (i * 37 + seed);
+		}
+		setCursorAddress(address);
 		writeStart();
-		writeNextByte(value);
+		writeNextBytes(pattern, length);
+		writeEnd();
+		setCursorAddress(address);
+		readStart();
+		readNextBytes(readBack, length);
+		return memcmp(pattern, readBack, length) == 0;
 	}
 
-	/// Start reading.
-	void readStart()
+
+
+	/* Basic methods */
+public:
+	/// Move data read/write cursor to address inside display. With shadow
+	/// memory, moving the controller cursor is deferred until needed.
+	inline void setCursorAddress(uint16_t address)
 	{
-		if (needDummyRead) {
-			needDummyRead = false;
-			write<Command>(0b1101);
-			read<Data>();
+		if (Memory::enabled) {
+			this->setShadowPosition(address);
+			return;
 		}
-		write<Command>(0b1101); // Read display data
-	}
-	/// Read next byte (after writing started).
-	inline uint8_t readNextByte()
-	{
-		return read<Data>();
-	}
-	/// Read single byte.
-	inline uint8_t readSingleByte()
-	{
-		readStart();
-		return readNextByte();
+		moveCursor(address);
 	}
 
-	/// Set bit in next byte.
-	inline void setDataBit(const uint8_t which)
+protected:
+	/// Move controller cursor to address. Skipped if the cursor is known to
+	/// be there already (with no data prefetched by read), and only lower 
+	/// address is written if upper address stays the same.
+	void moveCursor(uint16_t address)
 	{
-		write<Command>(0b1111);
-		write<Data>(which);
-	}
-	/// Clear bit in next byte.
-	inline void clearDataBit(const uint8_t which) {
-		write<Command>(0b1110);
-		write<Data>(which);
+		if (cursorKnown && needDummyRead && cursor == address) {
+			return;
+		}
+		writeInstruction(0b1010, address & 0xff); // Set cursor lower address
+		if (!cursorKnown || ((cursor ^ address) & 0xff00)) {
+			writeInstruction(0b1011, address >> 8); // Set cursor upper address
+		}
+		cursor = address;
+		cursorKnown = true;
+		needDummyRead = true;
 	}
-	/// Set or clear bit in byte depending on requested color.
-	inline void setDataBit(const uint8_t which, const bool black)
+
+public:
+	/// Forget modelled cursor position, so next `setCursorAddress` writes
+	/// full address, cached rows (see `RowCacheMemory`) and background hints.
+	/// Required after accessing the display other way than by the display 
+	/// methods.
+	inline void invalidateCursor()
 	{
-		write<Command>(0b1110 | black);
-		write<Data>(which);
+		cursorKnown = false;
+		needDummyRead = true;
+		this->cacheClear();
+		forgetAllBackground();
 	}
 
-	/// Set display duty to `1 / (value + 1)` (from 1:1 to 1:127). 
-	/// Note: The LC7981 specifies up to 256 divider, but it seems to glitch.
-	inline void setDisplayDuty(const uint8_t value)
+	/// Display memory policy, like to check the row cache counters.
+	inline Memory& memory()
 	{
-		write<Command>(0b0011);
-		write<Data>(value);
+		return *this;
 	}
 
-
-
-	/* Basic drawing */
-public:
-	/// Clear whole display using specified pattern.
-	void clear(const uint8_t pattern)
+protected:
+	/// Keep track of cursor moved by reads. As reads go only to primary one
+	/// of displays sharing the bus (see `SharedBus`), cursor crossing upper
+	/// address is forgotten, so upper address is written by next cursor set.
+	inline void advanceCursorByReads(const uint8_t count)
 	{
-		setCursorAddress(0);
-		writeStart();
-		for (uint8_t y = 0; y < height; y++) {
-			for (uint8_t x = 0; x < width; x += 8) {
-				writeNextByte(pattern);
-			}
+		const uint16_t previous = cursor;
+		cursor += count;
+		if ((previous ^ cursor) & 0xff00) {
+			cursorKnown = false;
 		}
 	}
-	/// Clear whole display white (empty).
-	inline void clearWhite()
-	{
-		clear(0);
-	}
-	/// Clear whole display black (filled).
-	inline void clearBlack()
+
+	/// Start writing (data burst) on the controller.
+	inline void beginWriting()
 	{
-		clear(0b11111111);
+		write<Command>(0b1100); // Write display data
+		this->beginWriteBurst();
+		writing = true;
+		writtenFrom = cursorKnown ? cursor : noAddress;
+		// Writing discards data prefetched by reading
+		needDummyRead = true;
 	}
-	/// Clear whole display gray (alternating bits pattern).
-	void clearGray()
+
+	/// Number of unchanged bytes cheaper to write again than moving cursor 
+	/// over them (lower address and write instructions), with shadow memory.
+	static constexpr uint8_t rewriteLimit = 2;
+
+	/// Make sure the controller is writing at given address (with shadow
+	/// memory), writing small gap of skipped bytes again if possible.
+	void writeStartAt(const uint16_t address)
 	{
-		setCursorAddress(0);
-		writeStart();
-		for (uint8_t y = 0; y < height; y += 2) {
-			for (uint8_t x = 0; x < width; x += 8) {
-				writeNextByte(0b10101010);
+		if (writing && cursorKnown) {
+			if (cursor == address) {
+				return;
 			}
-			for (uint8_t x = 0; x < width; x += 8) {
-				writeNextByte(0b01010101);
+			if (address > cursor && address - cursor <= rewriteLimit && address <= Memory::size) {
+				this->writeBytes(this->shadowBytes(cursor), address - cursor);
+				cursor = address;
+				return;
 			}
 		}
+		moveCursor(address);
+		beginWriting();
 	}
 
-	/// Set single bit at given coordinates.
-	/// For multiple bits you should more efficient methods than `setPixel` or `clearPixel`.
-	inline void setPixel(const uint8_t x, const uint8_t y)
+	/// Write bytes (given by `value` for index) at deferred position (with
+	/// shadow memory), using `writeRun` for runs of changed bytes (from start
+	/// index, of given length). Unchanged bytes are skipped, unless the gap
+	/// is small enough to be written again.
+	template <typename Value, typename WriteRun>
+	void writeShadowed(const uint16_t length, Value value, WriteRun writeRun)
 	{
-		setCursorAddress(width / 8 * y + x / 8);
-		setDataBit(x % 8);
+		const uint16_t address = this->shadowPosition();
+		this->setShadowPosition(address + length);
+		if (address + length > Memory::size) {
+			writeStartAt(address);
+			writeRun(0, length);
+			cursor += length;
+			return;
+		}
+		if (Memory::retained) {
+			for (uint16_t i = 0; i < length; i++) {
+				const uint8_t next = value(i);
+				if (this->shadowRead(address + i) != next) {
+					this->shadowWrite(address + i, next);
+					this->markDirty(address + i);
+				}
+			}
+			return;
+		}
+		uint16_t i = 0;
+		while (true) {
+			while (i < length && this->shadowRead(address + i) == value(i)) {
+				i++;
+			}
+			if (i == length) {
+				return;
+			}
+			const uint16_t start = i;
+			uint16_t end = i;
+			while (i < length) {
+				const uint8_t next = value(i);
+				if (this->shadowRead(address + i) != next) {
+					this->shadowWrite(address + i, next);
+					end = i + 1;
+				}
+				else if (i - end >= rewriteLimit) {
+					break;
+				}
+				i++;
+			}
+			writeStartAt(address + start);
+			writeRun(start, end - start);
+			cursor += end - start;
+		}
 	}
-	/// Clear single bit at given coordinates.
-	/// For multiple bits you should more efficient methods than `setPixel` or `clearPixel`.
-	inline void clearPixel(const uint8_t x, const uint8_t y)
+
+	/// Update cached bytes written at cursor (with row cache), or forget
+	/// them if the cursor is not known.
+	template <typename Value>
+	inline void cacheWritten(const uint16_t length, Value value)
 	{
-		setCursorAddress(width / 8 * y + x / 8);
-		clearDataBit(x % 8);
+		if (!Memory::cached) return;
+		if (cursorKnown) {
+			this->cacheStore(cursor, length, value);
+		}
+		else {
+			this->cacheClear();
+		}
 	}
-	/// Set or clear single bit at given coordinates depending on requested value.
-	/// For multiple bits you should more efficient methods than `setPixel` or `clearPixel`.
-	inline void setPixel(const uint8_t x, const uint8_t y, const bool black)
+
+	/// Update cached byte for bit operation at cursor (with row cache).
+	inline void cacheDataBit(const uint8_t which, const bool black)
 	{
-		setCursorAddress(width / 8 * y + x / 8);
-		setDataBit(x % 8, black);
+		if (!Memory::cached) return;
+		if (cursorKnown) {
+			this->cacheBit(cursor, which, black);
+		}
+		else {
+			this->cacheClear();
+		}
 	}
 
-	/// Draw horizontal line from specified point of specified length using specified pattern.
-	void drawHorizontalLine(const uint8_t x, const uint8_t y, const uint8_t length, const uint8_t pattern)
+	/// Update shadow copy for bit operation at deferred position (with shadow
+	/// memory), moving controller cursor there. Returns false if the bit is
+	/// not changed, so the operation can be skipped.
+	bool shadowDataBit(const uint8_t which, const bool black)
 	{
-		setCursorAddress(width / 8 * y + x / 8);
-		uint8_t remainingLength = length;
-		uint8_t p = x % 8;
-		if (p != 0) {
-			uint8_t mask;
-			if (length + p >= 8) {
-				mask = 0b11111111 << p;
-				remainingLength -= (8 - p);
+		const uint16_t address = this->shadowPosition();
+		this->setShadowPosition(address + 1);
+		if (address < Memory::size) {
+			const uint8_t current = this->shadowRead(address);
+			const uint8_t next = black ? (current | (1 << which)) : (current & ~(1 << which));
+			if (next == current) {
+				return false;
 			}
-			else {
-				mask = 0;
-				while (remainingLength) {
-					mask <<= 1;
-					mask |= 1;
-					remainingLength -= 1;
-				}
-				mask <<= p;
+			this->shadowWrite(address, next);
+			if (Memory::retained) {
+				this->markDirty(address);
+				return false;
 			}
-			uint8_t current = readSingleByte();
-			setCursorAddress(width / 8 * y + x / 8);
-			writeStart();
-			writeNextByte((pattern & mask) | (current & ~mask));
 		}
-		else {
-			writeStart();
+		moveCursor(address);
+		return true;
+	}
+
+public:
+	/// Start writing, unless already writing. Writing lasts until `writeEnd`
+	/// or any other operation. It should be ended explicitly if the bus is
+	/// shared with other devices, so the bus can be released. With shadow memory, the controller starts
+	/// writing when first changed byte is written.
+	inline void writeStart()
+	{
+		if (Memory::enabled || writing) {
+			return;
 		}
-		while (remainingLength >= 8) {
-			writeNextByte(pattern);
-			remainingLength -= 8;
+		beginWriting();
+	}
+	/// End writing (started by `writeStart`).
+	inline void writeEnd()
+	{
+		if (writing) {
+			forgetWritten();
+			writing = false;
+			this->endWriteBurst();
 		}
-		if (remainingLength > 0) {
-			uint8_t mask = 0;
-			while (remainingLength) {
-				mask <<= 1;
-				mask |= 1;
-				remainingLength -= 1;
+	}
+	/// Write next byte (after writing started).
+	inline void writeNextByte(uint8_t value)
+	{
+		if (Memory::enabled) {
+			const uint16_t address = this->shadowPosition();
+			this->setShadowPosition(address + 1);
+			if (address < Memory::size) {
+				if (this->shadowRead(address) == value) {
+					return;
+				}
+				this->shadowWrite(address, value);
+				if (Memory::retained) {
+					this->markDirty(address);
+					return;
+				}
 			}
-			uint8_t current = readSingleByte();
-			setCursorAddress(width / 8 * y + (x + length) / 8);
-			writeSingleByte((pattern & mask) | (current & ~mask));
+			writeStartAt(address);
 		}
+		cacheWritten(1, [&](const uint16_t) { return value; });
+		write<Data>(value);
+		cursor += 1;
 	}
-	/// Draw black horizontal line from specified point of specified length.
-	inline void drawBlackHorizontalLine(const uint8_t x, const uint8_t y, const uint8_t length)
+	/// Write next bytes (after writing started).
+	inline void writeNextBytes(const uint8_t* data, uint16_t length)
 	{
-		drawHorizontalLine(x, y, length, 0b11111111);
+		if (Memory::enabled) {
+			return writeShadowed(length, 
+				[&](const uint16_t i) { return data[i]; },
+				[&](const uint16_t start, const uint16_t count) { this->writeBytes(data + start, count); }
+			);
+		}
+		cacheWritten(length, [&](const uint16_t i) { return data[i]; });
+		this->writeBytes(data, length);
+		cursor += length;
 	}
-	/// Draw white horizontal line from specified point of specified length.
-	inline void drawWhiteHorizontalLine(const uint8_t x, const uint8_t y, const uint8_t length)
+	/// Write the same byte multiple times (after writing started).
+	inline void writeNextRepeat(uint8_t value, uint16_t count)
 	{
-		drawHorizontalLine(x, y, length, 0b00000000);
+		if (Memory::enabled) {
+			return writeShadowed(count, 
+				[&](const uint16_t) { return value; },
+				[&](const uint16_t, const uint16_t length) { this->writeRepeat(value, length); }
+			);
+		}
+		cacheWritten(count, [&](const uint16_t) { return value; });
+		this->writeRepeat(value, count);
+		cursor += count;
+	}
+	/// Write single byte.
+	inline void writeSingleByte(uint8_t value)
+	{
+		writeStart();
+		writeNextByte(value);
+		writeEnd();
 	}
 
-	/// Draw black vertical line from specified point of specified length.
-	void drawBlackVerticalLine(const uint8_t x, const uint8_t y, const uint8_t length)
+	/// Start reading. Reading always goes to the controller, even with 
+	/// shadow memory (in retained mode, changes are flushed first).
+	void readStart()
 	{
-		for (uint8_t i = y; i < y + length; i++) {
-			setCursorAddress(width / 8 * i + x / 8);
-			setDataBit(x % 8);
+		if (Memory::retained) {
+			flush();
+		}
+		if (Memory::enabled) {
+			moveCursor(this->shadowPosition());
+		}
+		write<Command>(0b1101); // Read display data
+		if (needDummyRead) {
+			// First read after setting cursor returns stale data, but the
+			// controller stays in reading mode, so no need to repeat command.
+			needDummyRead = false;
+			read<Data>();
+			advanceCursorByReads(1);
 		}
 	}
-	/// Draw white vertical line from specified point of specified length.
-	void drawWhiteVerticalLine(const uint8_t x, const uint8_t y, const uint8_t length)
+	/// Read next byte (after reading started).
+	inline uint8_t readNextByte()
 	{
-		for (uint8_t i = y; i < y + length; i++) {
-			setCursorAddress(width / 8 * i + x / 8);
-			clearDataBit(x % 8);
+		advanceCursorByReads(1);
+		return read<Data>();
+	}
+	/// Read next bytes (after reading started).
+	inline void readNextBytes(uint8_t* data, uint16_t length)
+	{
+		this->readBytes(data, length);
+		while (length) {
+			// Steps keeping every upper address crossing noticed
+			const uint8_t step = length < 128 ? length : 128;
+			advanceCursorByReads(step);
+			length -= step;
+		}
+	}
+	/// Read single byte. With shadow memory, it is read from the copy. With
+	/// row cache, it is read from the cache if possible, not moving the 
+	/// controller cursor then (set the cursor before next access).
+	inline uint8_t readSingleByte()
+	{
+		if (Memory::enabled) {
+			const uint16_t address = this->shadowPosition();
+			if (address < Memory::size) {
+				return this->shadowRead(address);
+			}
+			moveCursor(address);
+		}
+		if (Memory::cached && cursorKnown) {
+			// Byte already prefetched by reading is before the cursor
+			const uint16_t address = needDummyRead ? cursor : cursor - 1;
+			uint8_t value;
+			if (!this->cacheLoad(address, value)) {
+				value = readControllerByte();
+				this->cacheFill(address, value);
+			}
+			return value;
 		}
+		return readControllerByte();
 	}
 
-	/// Draw line from specified point of specified length using white or black.
-	void drawLine(uint8_t x0, uint8_t y0, const uint8_t x1, const uint8_t y1, const bool black)
+protected:
+	/// Read single byte from the controller.
+	inline uint8_t readControllerByte()
 	{
-		if (x0 > x1) {
-			return drawLine(x1, y1, x0, y0, black);
+		write<Command>(0b1101); // Read display data
+		if (needDummyRead) {
+			// Dummy and actual read done as one burst
+			needDummyRead = false;
+			uint8_t data[2];
+			this->readBytes(data, 2);
+			advanceCursorByReads(2);
+			return data[1];
 		}
-		
-		const uint8_t dx = x1 - x0;
-		if (y0 == y1) {
-			return drawHorizontalLine(x0, y0, dx + 1, black ? 0b11111111 : 0);
+		return readNextByte();
+	}
+
+public:
+	/// Set bit in next byte.
+	inline void setDataBit(const uint8_t which)
+	{
+		if (Memory::enabled && !shadowDataBit(which, true)) {
+			return;
 		}
-		
-		if (y1 > y0) {
-			const uint8_t dy = y1 - y0;
-			if (dx == 0) {
-				if (black) {
-					return drawWhiteVerticalLine(x0, y0, dy + 1);
-				}
-				else {
-					return drawBlackVerticalLine(x0, y0, dy + 1);
-				}
-			}
+		cacheDataBit(which, true);
+		forgetBackgroundAtCursor();
+		writeInstruction(0b1111, which);
+		cursor += 1;
+		needDummyRead = true;
+	}
+	/// Clear bit in next byte.
+	inline void clearDataBit(const uint8_t which) {
+		if (Memory::enabled && !shadowDataBit(which, false)) {
+			return;
+		}
+		cacheDataBit(which, false);
+		forgetBackgroundAtCursor();
+		writeInstruction(0b1110, which);
+		cursor += 1;
+		needDummyRead = true;
+	}
+	/// Set or clear bit in byte depending on requested color.
+	inline void setDataBit(const uint8_t which, const bool black)
+	{
+		if (Memory::enabled && !shadowDataBit(which, black)) {
+			return;
+		}
+		cacheDataBit(which, black);
+		forgetBackgroundAtCursor();
+		writeInstruction(0b1110 | black, which);
+		cursor += 1;
+		needDummyRead = true;
+	}
 
-			int16_t err = dx - dy;
-			while (true) {
-				setPixel(x0, y0, black);
-				if (x0 == x1 && y0 == y1) {
-					break;
-				}
-				
-				const int16_t e2 = 2 * err;
-				if (-e2 <= dy) {
-					err -= dy;
-					x0 += 1;
-				}
-				if (e2 <= dx) {
-					err += dx;
-					y0 += 1;
+	/// Number of bits of partial byte, up to which changing them by bit
+	/// operations is cheaper than read-modify-write, by bus costs (see 
+	/// `BusBase`). For the edge byte of span, bit operations cost cursor 
+	/// set and instruction for each bit, read-modify-write costs reading
+	/// (command and two reads), cursor set and writing (data and command,
+	/// as bit operations end writing). Zero with shadow memory, as reading
+	/// is free then, and the byte can be just overwritten.
+	static constexpr uint8_t bitOperationsLimit = Memory::enabled ? 0 
+		: (Bus::registerCost + Bus::writeCost + Bus::readCost) / Bus::registerCost;
+
+	/// Change bits of byte at given address selected by mask to given value,
+	/// by bit operations or read-modify-write, whichever is cheaper (see 
+	/// `bitOperationsLimit`), or by just writing it if background of the row
+	/// is known (see `rowBackground`). Leaves cursor after the byte, maybe 
+	/// writing.
+	inline void writeMaskedByte(const uint16_t address, const uint8_t value, const uint8_t mask)
+	{
+		writeMaskedByte(address, value, mask, rowBackground(address));
+	}
+
+protected:
+	/// Count set bits of mask.
+	static inline uint8_t countBits(uint8_t mask)
+	{
+		uint8_t bits = 0;
+		for (; mask; mask &= mask - 1) {
+			bits++;
+		}
+		return bits;
+	}
+
+	/// Change bits of byte at given address selected by mask to given value,
+	/// composing it with given background byte (or `noBackground`).
+	void writeMaskedByte(const uint16_t address, const uint8_t value, const uint8_t mask, const uint16_t background)
+	{
+		if (!mask) return;
+		if (background != noBackground) {
+			setCursorAddress(address);
+			writeStart();
+			writeNextByte((value & mask) | (background & ~mask));
+			return;
+		}
+		if (countBits(mask) <= bitOperationsLimit) {
+			for (uint8_t which = 0; which < 8; which++) {
+				if (mask & (1 << which)) {
+					setCursorAddress(address);
+					setDataBit(which, value & (1 << which));
 				}
 			}
+			return;
 		}
-		else {
-			const uint8_t dy = y0 - y1;
-			if (dx == 0) {
-				if (black) {
-					return drawWhiteVerticalLine(x1, y1, dy + 1);
-				}
-				else {
-					return drawBlackVerticalLine(x1, y1, dy + 1);
-				}
+		setCursorAddress(address);
+		const uint8_t current = readSingleByte();
+		setCursorAddress(address);
+		writeStart();
+		writeNextByte((value & mask) | (current & ~mask));
+	}
+
+public:
+	/// Write bytes changed in retained mode (see `RetainedMemory`) to the
+	/// controller. Runs of dirty bytes are merged into one burst if the gap 
+	/// of clean bytes between is cheaper to write again than setting cursor
+	/// (and starting writing) for the next run. Does nothing otherwise.
+	void flush()
+	{
+		if (!Memory::retained) return;
+		flushRange(0, Memory::size, 0, 0);
+		writeEnd();
+		this->setFlushPosition(0);
+	}
+
+	/// Write bytes changed in retained mode for up to given time, so main
+	/// loop keeps its cadence, while the display catches up progressively.
+	/// Continues from where previous call stopped, top to bottom, wrapping 
+	/// around. The time is checked every `flushStep` bytes, so it can be 
+	/// exceeded by writing them. Returns true if everything is written.
+	bool flush(const unsigned long budgetMicros)
+	{
+		if (!Memory::retained) return true;
+		const unsigned long startTime = micros();
+		const uint16_t resume = this->flushPosition();
+		uint16_t stopped = flushRange(resume, Memory::size, startTime, budgetMicros);
+		if (stopped == Memory::size) {
+			stopped = flushRange(0, resume, startTime, budgetMicros);
+			if (stopped == resume) {
+				stopped = 0;
 			}
+		}
+		writeEnd();
+		this->setFlushPosition(stopped);
+		return stopped == 0 && this->nextDirty(0) >= Memory::size;
+	}
 
-			int16_t err = dx - dy;
-			while (true) {
-				setPixel(x0, y0, black);
-				if (x0 == x1 && y0 == y1) {
+	/// Write bytes changed in retained mode in given rows first, like the
+	/// area player looks at, before flushing rest with time budget.
+	void flushRows(const uint8_t y, const uint8_t count)
+	{
+		if (!Memory::retained) return;
+		const uint16_t end = width / 8 * (y + count);
+		flushRange(width / 8 * y, end < Memory::size ? end : Memory::size, 0, 0);
+		writeEnd();
+	}
+
+protected:
+	/// Maximal number of bytes written by flush between checking the time.
+	static constexpr uint8_t flushStep = 32;
+
+	/// Write dirty runs in given address range (with retained memory), 
+	/// until given time budget (if any) is exceeded since start time. 
+	/// Returns address where it stopped, `end` if everything is written.
+	/// Range past the memory size is not flushed (nothing is dirty there).
+	uint16_t flushRange(uint16_t start, const uint16_t end, const unsigned long startTime, const unsigned long budgetMicros)
+	{
+		const uint16_t limit = end < Memory::size ? end : Memory::size;
+		start = this->nextDirty(start);
+		while (start < limit) {
+			uint16_t runEnd = start + 1;
+			while (runEnd - start < flushStep) {
+				const uint16_t next = this->nextDirty(runEnd);
+				// Lower address and write instructions, upper address too if changed
+				const uint8_t cursorCost = ((runEnd ^ next) & 0xff00) ? 5 : 3;
+				if (next >= limit || next - runEnd >= cursorCost) {
 					break;
 				}
-				
-				const int16_t e2 = 2 * err;
-				if (-e2 <= dy) {
-					err -= dy;
-					x0 += 1;
-				}
-				if (e2 <= dx) {
-					err += dx;
-					y0 -= 1;
-				}
+				runEnd = next + 1;
+			}
+			writeStartAt(start);
+			this->writeBytes(this->shadowBytes(start), runEnd - start);
+			cursor += runEnd - start;
+			this->markClean(start, runEnd - start);
+			start = this->nextDirty(runEnd);
+			if (budgetMicros && start < limit && micros() - startTime >= budgetMicros) {
+				return start;
 			}
 		}
+		return end;
 	}
-	/// Draw black line from specified point of specified length.
-	inline void drawBlackLine(uint8_t x0, uint8_t y0, const uint8_t x1, const uint8_t y1)
-	{
-		drawLine(x0, y0, x1, y1, true);
-	}
-	/// Draw white line from specified point of specified length.
-	inline void drawWhiteLine(uint8_t x0, uint8_t y0, const uint8_t x1, const uint8_t y1)
+
+public:
+	/// Set display duty to `1 / (value + 1)` (from 1:1 to 1:127). 
+	/// Note: The LC7981 specifies up to 256 divider, but it seems to glitch.
+	inline void setDisplayDuty(const uint8_t value)
 	{
-		drawLine(x0, y0, x1, y1, false);
+		writeInstruction(0b0011, value);
 	}
 
 
 
-	/* Basic shapes */
-public:
-	/// Draw black rectangle on give point with given size.
-	void drawBlackRectangle(const uint8_t x, const uint8_t y, const uint8_t w, const uint8_t h)
+	/* Background hints */
+protected:
+	/// Background hints of rows: not known, uniformly white, black, or 
+	/// filled as by last clearing (see `clearedPattern`).
+	static constexpr uint8_t hintUnknown = 0;
+	static constexpr uint8_t hintWhite = 1;
+	static constexpr uint8_t hintBlack = 2;
+	static constexpr uint8_t hintCleared = 3;
+
+	/// Value of background byte for not known background.
+	static constexpr uint16_t noBackground = 0x100;
+	/// Value of `writtenFrom` for not known address.
+	static constexpr uint16_t noAddress = 0xFFFF;
+
+	inline uint8_t backgroundHint(const uint8_t row) const
 	{
-		drawBlackHorizontalLine(x, y, w);
-		drawBlackHorizontalLine(x, y + h - 1, w);
-		drawBlackVerticalLine(x, y + 1, h - 2);
-		drawBlackVerticalLine(x + w - 1, y + 1, h - 2);
+		return (backgroundRows[row / 4] >> (row % 4 * 2)) & 0b11;
 	}
-	/// Draw white rectangle on give point with given size.
-	void drawWhiteRectangle(const uint8_t x, const uint8_t y, const uint8_t w, const uint8_t h)
+	inline void setBackgroundHint(const uint8_t row, const uint8_t hint)
 	{
-		drawWhiteHorizontalLine(x, y, w);
-		drawWhiteHorizontalLine(x, y + h - 1, w);
-		drawWhiteVerticalLine(x, y + 1, h - 2);
-		drawWhiteVerticalLine(x + w - 1, y + 1, h - 2);
+		const uint8_t shift = row % 4 * 2;
+		backgroundRows[row / 4] = (backgroundRows[row / 4] & ~(0b11 << shift)) | (hint << shift);
 	}
 
-	/// Draw filled black rectangle on give point with given size.
-	inline void drawBlackFill(const uint8_t x, const uint8_t y, const uint8_t w, const uint8_t h)
+	/// Remember the row is uniformly filled with given byte, if the byte can
+	/// be hinted (white, black or the cleared pattern).
+	void setRowBackground(const uint8_t y, const uint8_t value)
+	{
+		if (y >= backgroundHints) return;
+		const uint8_t hint = 
+			value == 0 ? hintWhite : 
+			value == 0b11111111 ? hintBlack : 
+			value == clearedPattern[y % 2] ? hintCleared : hintUnknown;
+		setBackgroundHint(y, hint);
+		anyBackground |= hint != hintUnknown;
+	}
+
+	/// Remember all rows are cleared with given bytes (for even and odd rows).
+	void setClearedBackground(const uint8_t even, const uint8_t odd)
 	{
-		for (uint8_t i = y; i < y + h; i++) {
-			drawBlackHorizontalLine(x, i, w);
+		if (!backgroundHints) return;
+		clearedPattern[0] = even;
+		clearedPattern[1] = odd;
+		for (uint8_t y = 0; y < height && y < backgroundHints; y++) {
+			setBackgroundHint(y, hintCleared);
 		}
+		anyBackground = true;
 	}
-	/// Draw filled white rectangle on give point with given size.
-	inline void drawWhiteFill(const uint8_t x, const uint8_t y, const uint8_t w, const uint8_t h)
+
+	/// Forget background of rows containing given range of addresses.
+	void forgetBackground(const uint16_t address, const uint16_t length)
 	{
-		for (uint8_t i = y; i < y + h; i++) {
-			drawWhiteHorizontalLine(x, i, w);
+		if (!anyBackground || !length) return;
+		const uint8_t rowBytes = width / 8;
+		const uint16_t last = (address + length - 1) / rowBytes;
+		for (uint16_t row = address / rowBytes; row <= last && row < backgroundHints; row++) {
+			setBackgroundHint(row, hintUnknown);
 		}
 	}
-	/// Draw filled gray rectangle on give point with given size.
-	inline void drawGrayFill(const uint8_t x, const uint8_t y, const uint8_t w, const uint8_t h)
+	/// Forget background of all rows.
+	inline void forgetAllBackground()
 	{
-		static const uint8_t PROGMEM pattern[] = {
-			0b1,
-			0b01010101,
-			0b10101010,
-		};
-		drawPatternFill(x, y, w, h, pattern);
+		if (!anyBackground) return;
+		memset(backgroundRows, 0, sizeof(backgroundRows));
+		anyBackground = false;
 	}
-
-	/// Draw custom pattern filling rectangle from given point with given size.
-	/// Pattern should be provided as pointer to PROGMEM array of bytes, where 
-	/// first value have value of `number of rows - 1`, followed by next rows 
-	/// bytes. Pattern width is 8 bits, number of rows must be power of two.
-	/// See `example/nice_custom_fill_patterns.hpp` for details and examples.
-	void drawPatternFill(const uint8_t x, const uint8_t y, const uint8_t w, const uint8_t h, const uint8_t* pattern)
+	/// Forget background of row of byte changed by bit operation at cursor.
+	inline void forgetBackgroundAtCursor()
 	{
-		const uint8_t mask = pgm_read_byte(pattern + 0);
-		const uint8_t limit = y + h; 
-		uint8_t i = y;
-		uint8_t p;
-		do {
-			p = pgm_read_byte(pattern + (i & mask) + 1);
-			drawHorizontalLine(x, i, w, p);
-			i += 1;
+		if (!backgroundHints) return;
+		if (cursorKnown) {
+			forgetBackground(cursor, 1);
 		}
-		while (i < limit);
+		else {
+			forgetAllBackground();
+		}
+	}
+	/// Forget background of rows written so far by current writing. Done
+	/// once for the whole burst, not for every byte.
+	inline void forgetWritten()
+	{
+		if (!backgroundHints || !writing) return;
+		if (writtenFrom == noAddress || !cursorKnown) {
+			forgetAllBackground();
+		}
+		else {
+			forgetBackground(writtenFrom, cursor - writtenFrom);
+		}
+		writtenFrom = cursor;
+	}
+
+	/// Get byte the row containing given address is known to be uniformly
+	/// filled with (after clearing, or full width line or fill, with nothing
+	/// else written to the row since), or `noBackground`. Partial bytes 
+	/// drawn over known background can be just written, with no reading.
+	/// With opaque drawing, it is the opaque background byte.
+	uint16_t rowBackground(const uint16_t address)
+	{
+		if (opaqueDrawing) return opaqueByte;
+		if (!backgroundHints) return noBackground;
+		forgetWritten();
+		if (!anyBackground) return noBackground;
+		const uint16_t row = address / (width / 8);
+		if (row >= backgroundHints) return noBackground;
+		switch (backgroundHint(row)) {
+			case hintWhite: return 0;
+			case hintBlack: return 0b11111111;
+			case hintCleared: return clearedPattern[row % 2];
+			default: return noBackground;
+		}
+	}
+
+
+
+	/* Opaque drawing */
+public:
+	/// Set opaque drawing. Horizontal lines, fills and text then own whole
+	/// bytes they touch, so the pixels next to them (up to byte boundaries)
+	/// are drawn with given background byte (white by default) instead of
+	/// being kept, and no reading is needed. Useful for labels in cells or
+	/// table rows, which own their bytes anyway. Bit operations (pixels,
+	/// vertical and sloped lines) are not affected. See also `OpaqueScope`.
+	inline void setOpaque(const bool enabled, const uint8_t background = 0)
+	{
+		opaqueDrawing = enabled;
+		opaqueByte = background;
+	}
+	/// Whether opaque drawing is set (see `setOpaque`).
+	inline bool isOpaque() const
+	{
+		return opaqueDrawing;
+	}
+	/// Background byte used by opaque drawing (see `setOpaque`).
+	inline uint8_t opaqueBackground() const
+	{
+		return opaqueByte;
+	}
+
+	/// Opaque drawing (see `setOpaque`) for lifetime of the object, with 
+	/// previous mode restored at its end.
+	class OpaqueScope
+	{
+		BasicDisplay& display;
+		const bool wasOpaque;
+		const uint8_t wasBackground;
+
+	public:
+		OpaqueScope(BasicDisplay& display, const uint8_t background = 0)
+			: display(display), wasOpaque(display.isOpaque()), wasBackground(display.opaqueBackground())
+		{
+			display.setOpaque(true, background);
+		}
+		~OpaqueScope()
+		{
+			display.setOpaque(wasOpaque, wasBackground);
+		}
+	};
+
+
+
+	/* Buffered writing */
+protected:
+	/// Buffer to collect bytes on stack, to write them at once.
+	struct WriteBuffer
+	{
+		uint8_t length;
+		/// Mask of bits to be changed in first byte (partial at start of
+		/// unaligned drawing), until it is written.
+		uint8_t firstMask;
+		/// Background of the row, known before drawing (see `rowBackground`).
+		uint16_t background;
+		/// Address where the collected bytes are to be written.
+		uint16_t address;
+		uint8_t data[LC7981_WRITE_BUFFER_SIZE];
+	};
+
+	/// Prepare the buffer for collecting bytes to be written at given address.
+	inline void startBuffer(WriteBuffer& buffer, const uint16_t address, const uint8_t firstMask = 0b11111111)
+	{
+		buffer.length = 0;
+		buffer.firstMask = firstMask;
+		buffer.address = address;
+		buffer.background = rowBackground(address);
+	}
+
+	/// Put next byte into the buffer, writing the buffer if it gets full.
+	inline void bufferNextByte(WriteBuffer& buffer, const uint8_t value)
+	{
+		buffer.data[buffer.length++] = value;
+		if (buffer.length == sizeof(buffer.data)) {
+			flushBuffer(buffer);
+		}
+	}
+
+	/// Write all bytes collected in the buffer, partial first byte by 
+	/// `writeMaskedByte`.
+	void flushBuffer(WriteBuffer& buffer)
+	{
+		if (!buffer.length) return;
+		uint8_t start = 0;
+		if (buffer.firstMask != 0b11111111) {
+			writeMaskedByte(buffer.address, buffer.data[0], buffer.firstMask, buffer.background);
+			buffer.firstMask = 0b11111111;
+			start = 1;
+		}
+		if (start < buffer.length) {
+			setCursorAddress(buffer.address + start);
+			writeStart();
+			writeNextBytes(buffer.data + start, buffer.length - start);
+		}
+		buffer.address += buffer.length;
+		buffer.length = 0;
+	}
+
+	/// Write last partial byte of buffered drawing (low bits, up to given
+	/// count), after flushing the buffer. If the first byte was not written
+	/// yet, it is the same byte.
+	inline void flushBufferLastBits(WriteBuffer& buffer, const uint8_t value, const uint8_t bits)
+	{
+		writeMaskedByte(buffer.address, value, ~(0b11111111 << bits) & buffer.firstMask, buffer.background);
+	}
+
+
+
+	/* Basic drawing */
+public:
+	/// Clear whole display using specified pattern.
+	void clear(const uint8_t pattern)
+	{
+		setCursorAddress(0);
+		writeStart();
+		writeNextRepeat(pattern, width / 8 * height);
+		writeEnd();
+		setClearedBackground(pattern, pattern);
+	}
+	/// Clear whole display white (empty).
+	inline void clearWhite()
+	{
+		clear(0);
+	}
+	/// Clear whole display black (filled).
+	inline void clearBlack()
+	{
+		clear(0b11111111);
+	}
+	/// Clear whole display gray (alternating bits pattern).
+	void clearGray()
+	{
+		setCursorAddress(0);
+		writeStart();
+		for (uint8_t y = 0; y < height; y += 2) {
+			writeNextRepeat(0b10101010, width / 8);
+			writeNextRepeat(0b01010101, width / 8);
+		}
+		writeEnd();
+		setClearedBackground(0b10101010, 0b01010101);
+	}
+
+	/// Set single bit at given coordinates.
+	/// For multiple bits you should more efficient methods than `setPixel` or `clearPixel`.
+	inline void setPixel(const uint8_t x, const uint8_t y)
+	{
+		setCursorAddress(width / 8 * y + x / 8);
+		setDataBit(x % 8);
+	}
+	/// Clear single bit at given coordinates.
+	/// For multiple bits you should more efficient methods than `setPixel` or `clearPixel`.
+	inline void clearPixel(const uint8_t x, const uint8_t y)
+	{
+		setCursorAddress(width / 8 * y + x / 8);
+		clearDataBit(x % 8);
+	}
+	/// Set or clear single bit at given coordinates depending on requested value.
+	/// For multiple bits you should more efficient methods than `setPixel` or `clearPixel`.
+	inline void setPixel(const uint8_t x, const uint8_t y, const bool black)
+	{
+		setCursorAddress(width / 8 * y + x / 8);
+		setDataBit(x % 8, black);
+	}
+
+	/// Draw horizontal line from specified point of specified length using specified pattern.
+	/// Partial bytes at the ends are changed by bit operations or read-modify-write,
+	/// whichever is cheaper for the bus (see `drawFillRows`). Line over 
+	/// full width makes the row background known (see `rowBackground`).
+	inline void drawHorizontalLine(const uint8_t x, const uint8_t y, const uint8_t length, const uint8_t pattern)
+	{
+		drawFillRows(x, y, length, 1, [&](const uint8_t) { return pattern; });
+	}
+	/// Draw span of bytes (`length` long, inside single row) starting at
+	/// given address using specified pattern, keeping background bits 
+	/// outside of masks of first and last byte.
+	void drawMaskedSpan(uint16_t address, uint8_t length, const uint8_t pattern, uint8_t firstMask, const uint8_t lastMask)
+	{
+		if (length == 1) {
+			firstMask &= lastMask;
+		}
+		// Known before drawing, as the row is no longer uniform after
+		const uint16_t background = (firstMask & lastMask) != 0b11111111 ? rowBackground(address) : noBackground;
+		if (firstMask != 0b11111111) {
+			writeMaskedByte(address, pattern, firstMask, background);
+			address += 1;
+			length -= 1;
+			if (!length) return;
+		}
+		if (lastMask != 0b11111111) {
+			length -= 1;
+		}
+		if (length) {
+			setCursorAddress(address);
+			writeStart();
+			writeNextRepeat(pattern, length);
+		}
+		if (lastMask != 0b11111111) {
+			writeMaskedByte(address + length, pattern, lastMask, background);
+		}
+	}
+	/// Draw row of bytes (from RAM) starting at given byte column, keeping
+	/// background bits outside of masks of first and last byte.
+	void drawMaskedRow(const uint8_t column, const uint8_t y, const uint8_t* data, const uint8_t length, uint8_t firstMask, const uint8_t lastMask)
+	{
+		if (!length) return;
+		uint16_t address = width / 8 * y + column;
+		if (length == 1) {
+			firstMask &= lastMask;
+		}
+		const uint16_t background = rowBackground(address);
+		uint8_t first = 0;
+		uint8_t end = length;
+		if (firstMask != 0b11111111) {
+			writeMaskedByte(address, data[0], firstMask, background);
+			first = 1;
+		}
+		if (length > 1 && lastMask != 0b11111111) {
+			end -= 1;
+		}
+		if (first < end) {
+			setCursorAddress(address + first);
+			writeStart();
+			writeNextBytes(data + first, end - first);
+		}
+		if (end < length) {
+			writeMaskedByte(address + end, data[end], lastMask, background);
+		}
+		writeEnd();
+	}
+
+	/// Draw black horizontal line from specified point of specified length.
+	inline void drawBlackHorizontalLine(const uint8_t x, const uint8_t y, const uint8_t length)
+	{
+		drawHorizontalLine(x, y, length, 0b11111111);
+	}
+	/// Draw white horizontal line from specified point of specified length.
+	inline void drawWhiteHorizontalLine(const uint8_t x, const uint8_t y, const uint8_t length)
+	{
+		drawHorizontalLine(x, y, length, 0b00000000);
+	}
+
+	/// Draw black vertical line from specified point of specified length.
+	void drawBlackVerticalLine(const uint8_t x, const uint8_t y, const uint8_t length)
+	{
+		for (uint8_t i = y; i < y + length; i++) {
+			setCursorAddress(width / 8 * i + x / 8);
+			setDataBit(x % 8);
+		}
+	}
+	/// Draw white vertical line from specified point of specified length.
+	void drawWhiteVerticalLine(const uint8_t x, const uint8_t y, const uint8_t length)
+	{
+		for (uint8_t i = y; i < y + length; i++) {
+			setCursorAddress(width / 8 * i + x / 8);
+			clearDataBit(x % 8);
+		}
+	}
+
+	/// Draw line from specified point of specified length using white or black.
+	void drawLine(uint8_t x0, uint8_t y0, const uint8_t x1, const uint8_t y1, const bool black)
+	{
+		if (x0 > x1) {
+			return drawLine(x1, y1, x0, y0, black);
+		}
+		
+		const uint8_t dx = x1 - x0;
+		if (y0 == y1) {
+			return drawHorizontalLine(x0, y0, dx + 1, black ? 0b11111111 : 0);
+		}
+		
+		if (y1 > y0) {
+			const uint8_t dy = y1 - y0;
+			if (dx == 0) {
+				if (black) {
+					return drawBlackVerticalLine(x0, y0, dy + 1);
+				}
+				else {
+					return drawWhiteVerticalLine(x0, y0, dy + 1);
+				}
+			}
+
+			int16_t err = dx - dy;
+			while (true) {
+				setPixel(x0, y0, black);
+				if (x0 == x1 && y0 == y1) {
+					break;
+				}
+				
+				const int16_t e2 = 2 * err;
+				if (-e2 <= dy) {
+					err -= dy;
+					x0 += 1;
+				}
+				if (e2 <= dx) {
+					err += dx;
+					y0 += 1;
+				}
+			}
+		}
+		else {
+			const uint8_t dy = y0 - y1;
+			if (dx == 0) {
+				if (black) {
+					return drawBlackVerticalLine(x1, y1, dy + 1);
+				}
+				else {
+					return drawWhiteVerticalLine(x1, y1, dy + 1);
+				}
+			}
+
+			int16_t err = dx - dy;
+			while (true) {
+				setPixel(x0, y0, black);
+				if (x0 == x1 && y0 == y1) {
+					break;
+				}
+				
+				const int16_t e2 = 2 * err;
+				if (-e2 <= dy) {
+					err -= dy;
+					x0 += 1;
+				}
+				if (e2 <= dx) {
+					err += dx;
+					y0 -= 1;
+				}
+			}
+		}
+	}
+	/// Draw black line from specified point of specified length.
+	inline void drawBlackLine(uint8_t x0, uint8_t y0, const uint8_t x1, const uint8_t y1)
+	{
+		drawLine(x0, y0, x1, y1, true);
+	}
+	/// Draw white line from specified point of specified length.
+	inline void drawWhiteLine(uint8_t x0, uint8_t y0, const uint8_t x1, const uint8_t y1)
+	{
+		drawLine(x0, y0, x1, y1, false);
+	}
+
+
+
+	/* Basic shapes */
+protected:
+	/// Fill rectangle from given point with given size, using byte given by
+	/// `rowPattern` for each row (by its y). Edge masks and bytes span are
+	/// computed once, and rows are walked by address. Each row is written 
+	/// as single burst, including partial edge bytes if the background is
+	/// known (see `rowBackground`) or read, while edges narrow enough (see
+	/// `bitOperationsLimit`) are changed by bit operations around it. Rectangle
+	/// over full width is written as one burst, making rows background
+	/// known.
+	template <typename RowPattern>
+	void drawFillRows(const uint8_t x, const uint8_t y, const uint8_t w, const uint8_t h, RowPattern rowPattern)
+	{
+		if (!w || !h) return;
+		const uint8_t rowBytes = width / 8;
+		uint16_t address = rowBytes * y + x / 8;
+		if (x == 0 && w == width) {
+			setCursorAddress(address);
+			writeStart();
+			for (uint8_t i = 0; i < h; i++) {
+				writeNextRepeat(rowPattern(y + i), rowBytes);
+			}
+			writeEnd();
+			for (uint8_t i = 0; i < h; i++) {
+				setRowBackground(y + i, rowPattern(y + i));
+			}
+			return;
+		}
+
+		const uint8_t last = x + w - 1;
+		const uint8_t length = last / 8 - x / 8 + 1;
+		uint8_t firstMask = 0b11111111 << (x % 8);
+		const uint8_t lastMask = 0b11111111 >> (7 - last % 8);
+		if (length == 1) {
+			firstMask &= lastMask;
+		}
+		const bool firstPartial = firstMask != 0b11111111;
+		const bool lastPartial = length > 1 && lastMask != 0b11111111;
+		const uint8_t middle = length - firstPartial - lastPartial;
+		const bool firstByBits = firstPartial && countBits(firstMask) <= bitOperationsLimit;
+		const bool lastByBits = lastPartial && countBits(lastMask) <= bitOperationsLimit;
+		const uint16_t lastOffset = length - 1;
+
+		for (uint8_t i = 0; i < h; i++, address += rowBytes) {
+			const uint8_t pattern = rowPattern(y + i);
+			const uint16_t background = firstPartial || lastPartial ? rowBackground(address) : noBackground;
+			const bool known = background != noBackground;
+			// Edges written in the burst, composed with background or read
+			const bool firstInBurst = firstPartial && (known || !firstByBits);
+			const bool lastInBurst = lastPartial && (known || !lastByBits);
+			uint8_t firstByte = background;
+			uint8_t lastByte = background;
+			if (!known) {
+				if (firstInBurst) {
+					setCursorAddress(address);
+					firstByte = readSingleByte();
+				}
+				if (lastInBurst && !Memory::cached) {
+					setCursorAddress(address + lastOffset);
+					lastByte = readSingleByte();
+				}
+			}
+
+			// Edges by bit operations around the burst, so the cursor is
+			// moved by them where the next access goes
+			if (firstPartial && !firstInBurst) {
+				writeMaskedByte(address, pattern, firstMask, noBackground);
+			}
+			const bool burst = firstInBurst || lastInBurst || middle;
+			if (burst) {
+				setCursorAddress(firstPartial && !firstInBurst ? address + 1 : address);
+				writeStart();
+			}
+			if (firstInBurst) {
+				writeNextByte((pattern & firstMask) | (firstByte & ~firstMask));
+			}
+			if (middle) {
+				writeNextRepeat(pattern, middle);
+			}
+			if (lastInBurst) {
+				if (!known && Memory::cached) {
+					// Read when reached, so hit in cache doesn't break the burst
+					setCursorAddress(address + lastOffset);
+					lastByte = readSingleByte();
+					setCursorAddress(address + lastOffset);
+					writeStart();
+				}
+				writeNextByte((pattern & lastMask) | (lastByte & ~lastMask));
+			}
+			if (lastPartial && !lastInBurst) {
+				writeMaskedByte(address + lastOffset, pattern, lastMask, noBackground);
+			}
+		}
+		writeEnd();
+	}
+
+public:
+	/// Draw black rectangle on give point with given size.
+	void drawBlackRectangle(const uint8_t x, const uint8_t y, const uint8_t w, const uint8_t h)
+	{
+		drawBlackHorizontalLine(x, y, w);
+		drawBlackHorizontalLine(x, y + h - 1, w);
+		drawBlackVerticalLine(x, y + 1, h - 2);
+		drawBlackVerticalLine(x + w - 1, y + 1, h - 2);
+	}
+	/// Draw white rectangle on give point with given size.
+	void drawWhiteRectangle(const uint8_t x, const uint8_t y, const uint8_t w, const uint8_t h)
+	{
+		drawWhiteHorizontalLine(x, y, w);
+		drawWhiteHorizontalLine(x, y + h - 1, w);
+		drawWhiteVerticalLine(x, y + 1, h - 2);
+		drawWhiteVerticalLine(x + w - 1, y + 1, h - 2);
+	}
+
+	/// Draw filled black rectangle on give point with given size.
+	inline void drawBlackFill(const uint8_t x, const uint8_t y, const uint8_t w, const uint8_t h)
+	{
+		drawFillRows(x, y, w, h, [](const uint8_t) { return 0b11111111; });
+	}
+	/// Draw filled white rectangle on give point with given size.
+	inline void drawWhiteFill(const uint8_t x, const uint8_t y, const uint8_t w, const uint8_t h)
+	{
+		drawFillRows(x, y, w, h, [](const uint8_t) { return 0b00000000; });
+	}
+	/// Draw filled gray rectangle on give point with given size.
+	inline void drawGrayFill(const uint8_t x, const uint8_t y, const uint8_t w, const uint8_t h)
+	{
+		static const uint8_t PROGMEM pattern[] = {
+			0b1,
+			0b01010101,
+			0b10101010,
+		};
+		drawPatternFill(x, y, w, h, pattern);
+	}
+
+	/// Draw custom pattern filling rectangle from given point with given size.
+	/// Pattern should be provided as pointer to PROGMEM array of bytes, where 
+	/// first value have value of `number of rows - 1`, followed by next rows 
+	/// bytes. Pattern width is 8 bits, number of rows must be power of two.
+	/// See `example/nice_custom_fill_patterns.hpp` for details and examples.
+	void drawPatternFill(const uint8_t x, const uint8_t y, const uint8_t w, const uint8_t h, const uint8_t* pattern)
+	{
+		const uint8_t mask = pgm_read_byte(pattern + 0);
+		drawFillRows(x, y, w, h, [&](const uint8_t row) {
+			return pgm_read_byte(pattern + (row & mask) + 1);
+		});
+	}
+
+
+
+
+	/* Text */
+public:
+#ifdef FONT_ANY_8X16
+	/// Draw text vertically using selected font, assuming font is 8x16 (special fast case)
+	void drawTextVertical_8x16(const uint8_t x, uint8_t y, const char* string, const void* font) {
+		if (!*string) return;
+		const uint8_t* fontData = static_cast<const uint8_t*>(font + sizeof(font_header_t));
+		const uint8_t p = x % 8; // bitsOffset
+		if (p != 0) {
+			const char* pointer;
+			WriteBuffer buffer;
+			for (uint8_t i = 0; i < 16; i++) {
+				pointer = string;
+
+				// First block, keeping background (see `flushBuffer`)
+				uint8_t prev = pgm_read_byte(fontData + (*pointer - ' ') * 16 + i);
+				pointer += 1;
+				startBuffer(buffer, width / 8 * y + x / 8, 0b11111111 << p);
+				// p == 3, prev == hgfedcba : (prev << p) == edcba???
+				bufferNextByte(buffer, prev << p);
+
+				// Middle blocks
+				while (*pointer) {
+					uint8_t next = pgm_read_byte(fontData + (*pointer - ' ') * 16 + i);
+					pointer += 1;
+					// if p == 3, prev == hgfedcba, next == HGFEDCBA :
+					//   (prev >> (8 - p)) == ?????hgf, (next << p) == EDCBA???
+					bufferNextByte(buffer, (prev >> (8 - p)) | (next << p));
+					prev = next;
+				}
+
+				flushBuffer(buffer);
+
+				// Last block, keeping background
+				flushBufferLastBits(buffer, prev >> (8 - p), p);
+
+				y += 1;
+			}
+		}
+		else {
+			const char* pointer;
+			WriteBuffer buffer;
+			for (uint8_t i = 0; i < 16; i++) {
+				pointer = string;
+				startBuffer(buffer, width / 8 * y + x / 8);
+				while (*pointer) {
+					bufferNextByte(buffer, pgm_read_byte(fontData + (*pointer - ' ') * 16 + i));
+					pointer += 1;
+				}
+				flushBuffer(buffer);
+				y += 1;
+			}
+		}
+		writeEnd();
+	}
+#endif
+
+	/// Draw text vertically using selected font, assuming font width is 8 bits or narrower.
+	/// Font chars rows bits are required to be padded with zeros while narrower than 8 bits.
+	void drawTextVertical_narrow(const uint8_t x, uint8_t y, const char* string, const void* font) {
+		const auto fontWidth  = static_cast<const font_header_t*>(font)->width;
+		const auto fontHeight = static_cast<const font_header_t*>(font)->height;
+		const uint8_t* fontData = static_cast<const uint8_t*>(font + sizeof(font_header_t));
+		const uint8_t fontRowBytes = fontHeight;
+		const uint8_t bitsOffset = x % 8;
+		const char* pointer;
+		WriteBuffer buffer;
+		for (uint8_t r = 0; r < fontHeight; r++) {
+			pointer = string;
+
+			uint8_t bitsPending = bitsOffset; // to be written
+			uint8_t nextByte = 0; // buffer for bits to be yet written
+
+			// Process next blocks, keeping background of first block if not
+			// aligned start (see `flushBuffer`)
+			startBuffer(buffer, width / 8 * y + x / 8, 0b11111111 << bitsOffset);
+			while (*pointer) {
+				const uint8_t data = pgm_read_byte(fontData + (*pointer - ' ') * fontRowBytes + r); // & mask
+
+				nextByte |= data << bitsPending;
+				bitsPending += fontWidth;
+
+				if (bitsPending >= 8) {
+					bufferNextByte(buffer, nextByte);
+					bitsPending -= 8;
+					nextByte = data >> (fontWidth - bitsPending);
+				}
+
+				pointer += 1;
+			}
+			flushBuffer(buffer);
+
+			// Write last block, keeping background, if not aligned end
+			if (bitsPending > 0) {
+				flushBufferLastBits(buffer, nextByte, bitsPending);
+			}
+
+			y += 1;
+		}
+		writeEnd();
+	}
+
+	/// Draw text vertically using selected font, assuming font width is above 8 bits.
+	/// Font chars rows bits should be connected and padded only to avoid mixing characters.
+	void drawTextVertical_wide(const uint8_t x, uint8_t y, const char* string, const void* font) {
+		const auto fontWidth  = static_cast<const font_header_t*>(font)->width;
+		const auto fontHeight = static_cast<const font_header_t*>(font)->height;
+		const uint8_t* fontData = static_cast<const uint8_t*>(font + sizeof(font_header_t));
+		const uint8_t fontRowBytes = (fontWidth * fontHeight + 7) / 8;
+		const uint8_t bitsOffset = x % 8;
+		const char* pointer;
+		WriteBuffer buffer;
+		for (uint8_t r = 0; r < fontHeight; r++) {
+			pointer = string;
+
+			uint8_t bitsPending = bitsOffset; // to be written
+			uint8_t nextByte = 0; // buffer for bits to be yet written
+
+			const uint8_t rowOffsetByte = r * fontWidth / 8;
+			const uint8_t rowOffsetBits = r * fontWidth % 8;
+
+			// Process next blocks, keeping background of first block if not
+			// aligned start (see `flushBuffer`)
+			startBuffer(buffer, width / 8 * y + x / 8, 0b11111111 << bitsOffset);
+			while (*pointer) {
+				uint8_t remainingFontWidth = fontWidth;
+				const uint8_t* charAddress = fontData + (*pointer - ' ') * fontRowBytes;
+				uint8_t byteOffset;
+
+				// TODO: use lambda to reduce program size a bit?
+
+				// Partial first byte 
+				if (rowOffsetBits) {
+					const uint8_t data = pgm_read_byte(charAddress + rowOffsetByte) >> rowOffsetBits;
+					const uint8_t length = 8 - rowOffsetBits;
+
+					nextByte |= data << bitsPending;
+					bitsPending += length;
+					remainingFontWidth -= length;
+
+					if (bitsPending >= 8) {
+						bufferNextByte(buffer, nextByte);
+						bitsPending -= 8;
+						nextByte = data >> (length - bitsPending);
+					}
+
+					byteOffset = 1;
+				}
+				else /* first byte is full too */ {
+					byteOffset = 0;
+				}
+
+				// Full bytes
+				while (remainingFontWidth > 8) {
+					const uint8_t data = pgm_read_byte(charAddress + rowOffsetByte + byteOffset);
+
+					nextByte |= data << bitsPending;
+					bufferNextByte(buffer, nextByte);
+					remainingFontWidth -= 8;
+					nextByte = data >> (8 - bitsPending);
+
+					byteOffset += 1;
+				}
+
+				// Last bits
+				{
+					const uint8_t data = pgm_read_byte(charAddress + rowOffsetByte + byteOffset) 
+						& ~(static_cast<uint8_t>(0b11111111) << remainingFontWidth);
+
+					nextByte |= data << bitsPending;
+					bitsPending += remainingFontWidth;
+
+					if (bitsPending >= 8) {
+						bufferNextByte(buffer, nextByte);
+						bitsPending -= 8;
+						nextByte = data >> (remainingFontWidth - bitsPending);
+					}
+				}
+
+				pointer += 1;
+			}
+			flushBuffer(buffer);
+
+			// Write last block, keeping background, if not aligned end
+			if (bitsPending > 0) {
+				flushBufferLastBits(buffer, nextByte, bitsPending);
+			}
+
+			y += 1;
+		}
+		writeEnd();
+	}
+
+	/// Draw text vertically using selected font
+	void drawTextVertical(const uint8_t x, const uint8_t y, const char* string, const void* font) {
+		const auto fontWidth  = static_cast<const font_header_t*>(font)->width;
+		const auto fontHeight = static_cast<const font_header_t*>(font)->height;
+#ifdef FONT_ANY_8X16
+		if (fontWidth == 8 && fontHeight == 16) {
+			return drawTextVertical_8x16(x, y, string, font);
+		}
+#endif
+		if (fontWidth <= 8) {
+			return drawTextVertical_narrow(x, y, string, font);
+		}
+		else {
+			return drawTextVertical_wide(x, y, string, font);
+		}
+	}
+};
+
+/// Display class base using virtual methods for IO. The other class should 
+/// extend it providing basic IO. Useful if the IO is to be selected at runtime
+/// or multiple different displays are to be handled by the same code, but it 
+/// costs indirect call for each byte. Prefer `BasicDisplay` with custom bus.
+class DisplayBase : public BasicDisplay<VirtualBus>
+{
+public:
+	/// Constructor
+	DisplayBase(uint8_t width, uint8_t height) 
+		: BasicDisplay(width, height)
+	{}
+	DisplayBase() : DisplayBase(240, 128) {}
+};
+
+/// Display class using virtual methods (`DisplayBase`) to access given bus.
+/// Allows to use any bus where `DisplayBase` is expected, or to compare the 
+/// performance of virtual and static (inlined) IO for the same bus.
+template <class Bus>
+class VirtualDisplay : public DisplayBase
+{
+public:
+	Bus bus;
+
+	/// Constructor
+	VirtualDisplay(uint8_t width, uint8_t height) 
+		: DisplayBase(width, height)
+	{}
+	VirtualDisplay() : VirtualDisplay(240, 128) {}
+
+protected:
+	void write(const register_t reg, const uint8_t val) override
+	{
+		bus.write(reg, val);
+	}
+
+	uint8_t read(const register_t reg) override
+	{
+		return bus.read(reg);
+	}
+
+	void init() override
+	{
+		bus.init();
+	}
+
+	void writeBytes(const uint8_t* data, uint16_t length) override
+	{
+		bus.writeBytes(data, length);
+	}
+
+	void writeRepeat(const uint8_t value, uint16_t count) override
+	{
+		bus.writeRepeat(value, count);
+	}
+
+	void readBytes(uint8_t* data, uint16_t length) override
+	{
+		bus.readBytes(data, length);
+	}
+
+	void writeRegister(const uint8_t instruction, const uint8_t value) override
+	{
+		bus.writeRegister(instruction, value);
+	}
+
+	void beginWriteBurst() override
+	{
+		bus.beginWriteBurst();
+	}
+
+	void endWriteBurst() override
+	{
+		bus.endWriteBurst();
+	}
+
+	bool setTimingLevel(const uint8_t level) override
+	{
+		return bus.setTimingLevel(level);
+	}
+};
+
+
+
+/// Bus queueing writes into ring buffer in RAM, so drawing doesn't block the
+/// caller until last byte is strobed. The queue is drained into the inner bus
+/// by `poll`, called from main loop or timer interrupt. If the queue is full,
+/// writing drains it (or waits for interrupt to drain it). Reads and timing
+/// changes wait until the queue is drained (`flushSync`), as they need the
+/// bus. Entries take 2 bytes each, `size` needs to be power of two.
+template <class Inner, uint8_t size = 64>
+class AsyncBus : public Inner
+{
+	static_assert(size >= 4 && (size & (size - 1)) == 0, "Queue size needs to be power of two.");
+
+public:
+	/// Reading waits until the queue is drained.
+	static constexpr uint8_t readCost = Inner::readCost < 64 ? Inner::readCost * 4 : 255;
+
+protected:
+	/// Queued operation kinds. Repeat is followed by entry with the count,
+	/// Register (with instruction) is followed by entry with the parameter.
+	enum operation_t : uint8_t {
+		WriteData = Data,
+		WriteCommand = Command,
+		Repeat,
+		Register,
+		BeginBurst,
+		EndBurst
+	};
+
+	struct Entry
+	{
+		uint8_t operation;
+		uint8_t value;
+	};
+
+	Entry entries[size];
+	/// Index of next entry to be written (by producer).
+	uint8_t head = 0;
+	/// Index of next entry to be drained (by consumer).
+	uint8_t tail = 0;
+	/// Flag of the queue being drained, so only one consumer runs at time.
+	bool draining = false;
+
+	/// Maximal number of repeated bytes written in one step of draining,
+	/// to avoid long blocking in interrupt.
+	static constexpr uint8_t repeatStep = 64;
+
+	inline uint8_t used()
+	{
+		return (__atomic_load_n(&head, __ATOMIC_RELAXED) - __atomic_load_n(&tail, __ATOMIC_ACQUIRE)) & (size - 1);
+	}
+
+	/// Wait until given number of entries is free, draining if necessary.
+	inline void reserve(const uint8_t count)
+	{
+		while (used() + count > size - 1) {
+			poll(1);
+		}
+	}
+
+	inline void push(const uint8_t operation, const uint8_t value)
+	{
+		reserve(1);
+		const uint8_t index = __atomic_load_n(&head, __ATOMIC_RELAXED);
+		entries[index] = { operation, value };
+		__atomic_store_n(&head, (index + 1) & (size - 1), __ATOMIC_RELEASE);
+	}
+
+	/// Try to become the consumer of the queue.
+	inline bool lock()
+	{
+#ifdef __AVR__
+		const uint8_t oldSREG = SREG;
+		cli();
+		const bool wasDraining = draining;
+		draining = true;
+		SREG = oldSREG;
+		return !wasDraining;
+#else
+		return !__atomic_exchange_n(&draining, true, __ATOMIC_ACQUIRE);
+#endif
+	}
+
+	inline void unlock()
+	{
+		__atomic_store_n(&draining, false, __ATOMIC_RELEASE);
+	}
+
+public:
+	/// Drain up to given number of entries from the queue into the inner bus.
+	/// Can be called from timer interrupt. Returns true if queue is empty.
+	bool poll(uint8_t maxEntries = size)
+	{
+		if (!lock()) {
+			return false;
+		}
+		uint8_t index = tail;
+		const uint8_t end = __atomic_load_n(&head, __ATOMIC_ACQUIRE);
+		while (index != end && maxEntries--) {
+			Entry& entry = entries[index];
+			switch (entry.operation) {
+				case WriteData:
+				case WriteCommand:
+					Inner::write(static_cast<register_t>(entry.operation), entry.value);
+					break;
+				case Repeat: {
+					// Count is kept in next entry, updated if not done at once
+					Entry& countEntry = entries[(index + 1) & (size - 1)];
+					uint16_t count = countEntry.operation | (countEntry.value << 8);
+					const uint8_t step = count > repeatStep ? repeatStep : count;
+					Inner::writeRepeat(entry.value, step);
+					count -= step;
+					if (count) {
+						countEntry.operation = count & 0xFF;
+						countEntry.value = count >> 8;
+						continue;
+					}
+					index = (index + 1) & (size - 1);
+					break;
+				}
+				case Register:
+					index = (index + 1) & (size - 1);
+					Inner::writeRegister(entry.value, entries[index].value);
+					break;
+				case BeginBurst:
+					Inner::beginWriteBurst();
+					break;
+				case EndBurst:
+					Inner::endWriteBurst();
+					break;
+			}
+			index = (index + 1) & (size - 1);
+			__atomic_store_n(&tail, index, __ATOMIC_RELEASE);
+		}
+		unlock();
+		return index == __atomic_load_n(&head, __ATOMIC_ACQUIRE);
 	}
 
-	// TODO: draw<*>Fill could be optimized - do mask calculation only once, instead per line.
+	/// Wait until all queued entries are written to the inner bus.
+	void flushSync()
+	{
+		while (!poll()) {}
+	}
 
+	/// Check whether the queue is empty.
+	inline bool idle()
+	{
+		return used() == 0;
+	}
 
+	void write(const register_t reg, const uint8_t value)
+	{
+		push(reg, value);
+	}
 
+	uint8_t read(const register_t reg)
+	{
+		flushSync();
+		return Inner::read(reg);
+	}
 
-	/* Text */
-public:
-#ifdef FONT_ANY_8X16
-	/// Draw text vertically using selected font, assuming font is 8x16 (special fast case)
-	void drawTextVertical_8x16(const uint8_t x, uint8_t y, const char* string, const void* font) {
-		if (!*string) return;
-		const font_header_t* fontHeader = static_cast<const font_header_t*>(font);
-		const uint8_t* fontData = static_cast<const uint8_t*>(font + sizeof(font_header_t));
-		const uint8_t p = x % 8; // bitsOffset
-		if (p != 0) {
-			const char* pointer;
-			for (uint8_t i = 0; i < 16; i++) {
-				pointer = string;
+	void init()
+	{
+		flushSync();
+		Inner::init();
+	}
 
-				// First block
-				uint8_t mask = 0b11111111 << p;
-				setCursorAddress(width / 8 * y + x / 8);
-				uint8_t current = readSingleByte();
-				uint8_t prev = pgm_read_byte(fontData + (*pointer - ' ') * 16 + i);
-				pointer += 1;
-				setCursorAddress(width / 8 * y + x / 8);
-				writeStart();
-				// p == 3, prev == hgfedcba : (prev << p) == edcba???
-				writeNextByte((current & ~mask) | (prev << p));
+	void writeBytes(const uint8_t* data, uint16_t length)
+	{
+		while (length--) {
+			push(WriteData, *data++);
+		}
+	}
 
-				// Middle blocks
-				while (*pointer) {
-					uint8_t next = pgm_read_byte(fontData + (*pointer - ' ') * 16 + i);
-					pointer += 1;
-					// if p == 3, prev == hgfedcba, next == HGFEDCBA :
-					//   (prev >> (8 - p)) == ?????hgf, (next << p) == EDCBA???
-					writeNextByte((prev >> (8 - p)) | (next << p));
-					prev = next;
-				}
+	void writeRepeat(const uint8_t value, uint16_t count)
+	{
+		if (!count) return;
+		reserve(2);
+		const uint8_t index = __atomic_load_n(&head, __ATOMIC_RELAXED);
+		entries[index] = { Repeat, value };
+		entries[(index + 1) & (size - 1)] = { 
+			static_cast<uint8_t>(count & 0xFF), static_cast<uint8_t>(count >> 8) 
+		};
+		__atomic_store_n(&head, (index + 2) & (size - 1), __ATOMIC_RELEASE);
+	}
 
-				// Last block
-				current = readSingleByte();
-				setCursorAddress(width / 8 * y + x / 8 + static_cast<size_t>(pointer - string));
-				writeStart();
-				writeNextByte((prev >> (8 - p)) | (current & mask));
+	void readBytes(uint8_t* data, uint16_t length)
+	{
+		flushSync();
+		Inner::readBytes(data, length);
+	}
 
-				y += 1;
-			}
+	void writeRegister(const uint8_t instruction, const uint8_t value)
+	{
+		reserve(2);
+		const uint8_t index = __atomic_load_n(&head, __ATOMIC_RELAXED);
+		entries[index] = { Register, instruction };
+		entries[(index + 1) & (size - 1)] = { 0, value };
+		__atomic_store_n(&head, (index + 2) & (size - 1), __ATOMIC_RELEASE);
+	}
+
+	void beginWriteBurst()
+	{
+		push(BeginBurst, 0);
+	}
+
+	void endWriteBurst()
+	{
+		push(EndBurst, 0);
+	}
+
+	bool setTimingLevel(const uint8_t level)
+	{
+		flushSync();
+		return Inner::setTimingLevel(level);
+	}
+};
+
+
+
+/// Data bus IO going pin by pin, working for any pins layout.
+template <
+	class IO, 
+	uint8_t DB0, uint8_t DB1, uint8_t DB2, uint8_t DB3,
+	uint8_t DB4, uint8_t DB5, uint8_t DB6, uint8_t DB7
+>
+struct PinsDataBus
+{
+	template <uint8_t pin>
+	using Pin = typename IO::template Pin<pin>;
+
+	static inline void input()
+	{
+		Pin<DB0>::input();
+		Pin<DB1>::input();
+		Pin<DB2>::input();
+		Pin<DB3>::input();
+		Pin<DB4>::input();
+		Pin<DB5>::input();
+		Pin<DB6>::input();
+		Pin<DB7>::input();
+	}
+
+	static inline void output()
+	{
+		Pin<DB0>::output();
+		Pin<DB1>::output();
+		Pin<DB2>::output();
+		Pin<DB3>::output();
+		Pin<DB4>::output();
+		Pin<DB5>::output();
+		Pin<DB6>::output();
+		Pin<DB7>::output();
+	}
+
+	static inline uint8_t read()
+	{
+		uint8_t out = 0;
+		out |= (Pin<DB0>::read() << 0);
+		out |= (Pin<DB1>::read() << 1);
+		out |= (Pin<DB2>::read() << 2);
+		out |= (Pin<DB3>::read() << 3);
+		out |= (Pin<DB4>::read() << 4);
+		out |= (Pin<DB5>::read() << 5);
+		out |= (Pin<DB6>::read() << 6);
+		out |= (Pin<DB7>::read() << 7);
+		return out;
+	}
+
+	static inline void write(const uint8_t in)
+	{
+		Pin<DB0>::write((in >> 0) & 1);
+		Pin<DB1>::write((in >> 1) & 1);
+		Pin<DB2>::write((in >> 2) & 1);
+		Pin<DB3>::write((in >> 3) & 1);
+		Pin<DB4>::write((in >> 4) & 1);
+		Pin<DB5>::write((in >> 5) & 1);
+		Pin<DB6>::write((in >> 6) & 1);
+		Pin<DB7>::write((in >> 7) & 1);
+	}
+};
+
+/// Pins IO using Arduino functions (`pinMode`, `digitalWrite`, `digitalRead`),
+/// slow but compatible with all boards and cores.
+struct ArduinoIO
+{
+	/// Minimal CPU cycles spent by pin write and read, unknown in this case.
+	static constexpr uint8_t pinWriteCycles = 0;
+	static constexpr uint8_t pinReadCycles = 0;
+
+	template <
+		uint8_t DB0, uint8_t DB1, uint8_t DB2, uint8_t DB3,
+		uint8_t DB4, uint8_t DB5, uint8_t DB6, uint8_t DB7
+	>
+	using DataBus = PinsDataBus<ArduinoIO, DB0, DB1, DB2, DB3, DB4, DB5, DB6, DB7>;
+
+	template <uint8_t pin>
+	struct Pin
+	{
+		static inline void write(const bool value)
+		{
+			digitalWrite(pin, value);
 		}
-		else {
-			const char* pointer;
-			for (uint8_t i = 0; i < 16; i++) {
-				pointer = string;
-				setCursorAddress(width / 8 * y + x / 8);
-				writeStart();
-				while (*pointer) {
-					writeNextByte(pgm_read_byte(fontData + (*pointer - ' ') * 16 + i));
-					pointer += 1;
-				}
-				y += 1;
-			}
+
+		static inline bool read()
+		{
+			return digitalRead(pin);
 		}
-	}
-#endif
 
-	/// Draw text vertically using selected font, assuming font width is 8 bits or narrower.
-	/// Font chars rows bits are required to be padded with zeros while narrower than 8 bits.
-	void drawTextVertical_narrow(const uint8_t x, uint8_t y, const char* string, const void* font) {
-		const auto fontWidth  = static_cast<const font_header_t*>(font)->width;
-		const auto fontHeight = static_cast<const font_header_t*>(font)->height;
-		const uint8_t* fontData = static_cast<const uint8_t*>(font + sizeof(font_header_t));
-		const uint8_t fontRowBytes = fontHeight;
-		const uint8_t bitsOffset = x % 8;
-		const char* pointer;
-		for (uint8_t r = 0; r < fontHeight; r++) {
-			pointer = string;
+		static inline void output()
+		{
+			pinMode(pin, OUTPUT);
+		}
 
-			uint8_t bitsPending = 0; // to be written
-			uint8_t nextByte = 0; // buffer for bits to be yet written
+		static inline void input()
+		{
+			pinMode(pin, INPUT);
+		}
+	};
+};
+
+#ifdef __AVR__
+
+/// Arduino pins mapping to ports and bits for known boards, resolved in
+/// compile-time by `FastIO`. Each pin is encoded as port index (A = 0, B = 1
+/// and so on) shifted by 3 bits, with the bit number in lower 3 bits.
+#define LC7981_PIN(port, bit) (((port) - 'A') << 3 | (bit))
+#if defined(__AVR_ATmega328P__) || defined(__AVR_ATmega328__) || \
+	defined(__AVR_ATmega168P__) || defined(__AVR_ATmega168A__) || defined(__AVR_ATmega168__) || \
+	defined(__AVR_ATmega88P__) || defined(__AVR_ATmega88A__) || defined(__AVR_ATmega88__) || \
+	defined(__AVR_ATmega8__)
+// Arduino Uno, Nano, Pro Mini and similar
+constexpr uint8_t fastPinsTable[] = {
+	LC7981_PIN('D', 0), LC7981_PIN('D', 1), LC7981_PIN('D', 2), LC7981_PIN('D', 3),
+	LC7981_PIN('D', 4), LC7981_PIN('D', 5), LC7981_PIN('D', 6), LC7981_PIN('D', 7),
+	LC7981_PIN('B', 0), LC7981_PIN('B', 1), LC7981_PIN('B', 2), LC7981_PIN('B', 3),
+	LC7981_PIN('B', 4), LC7981_PIN('B', 5),
+	LC7981_PIN('C', 0), LC7981_PIN('C', 1), LC7981_PIN('C', 2), LC7981_PIN('C', 3),
+	LC7981_PIN('C', 4), LC7981_PIN('C', 5),
+};
+#elif defined(__AVR_ATmega1284P__) || defined(__AVR_ATmega1284__) || \
+	defined(__AVR_ATmega644P__) || defined(__AVR_ATmega644A__) || defined(__AVR_ATmega644__) || \
+	defined(__AVR_ATmega324PA__) || defined(__AVR_ATmega324P__) || defined(__AVR_ATmega324A__) || \
+	defined(__AVR_ATmega164P__) || defined(__AVR_ATmega164A__) || \
+	defined(__AVR_ATmega32__) || defined(__AVR_ATmega16__) || defined(__AVR_ATmega8535__)
+// 40 pin chips with MightyCore standard pinout
+constexpr uint8_t fastPinsTable[] = {
+	LC7981_PIN('B', 0), LC7981_PIN('B', 1), LC7981_PIN('B', 2), LC7981_PIN('B', 3),
+	LC7981_PIN('B', 4), LC7981_PIN('B', 5), LC7981_PIN('B', 6), LC7981_PIN('B', 7),
+	LC7981_PIN('D', 0), LC7981_PIN('D', 1), LC7981_PIN('D', 2), LC7981_PIN('D', 3),
+	LC7981_PIN('D', 4), LC7981_PIN('D', 5), LC7981_PIN('D', 6), LC7981_PIN('D', 7),
+	LC7981_PIN('C', 0), LC7981_PIN('C', 1), LC7981_PIN('C', 2), LC7981_PIN('C', 3),
+	LC7981_PIN('C', 4), LC7981_PIN('C', 5), LC7981_PIN('C', 6), LC7981_PIN('C', 7),
+	LC7981_PIN('A', 0), LC7981_PIN('A', 1), LC7981_PIN('A', 2), LC7981_PIN('A', 3),
+	LC7981_PIN('A', 4), LC7981_PIN('A', 5), LC7981_PIN('A', 6), LC7981_PIN('A', 7),
+};
+#elif defined(__AVR_ATmega2560__) || defined(__AVR_ATmega1280__)
+// Arduino Mega
+constexpr uint8_t fastPinsTable[] = {
+	LC7981_PIN('E', 0), LC7981_PIN('E', 1), LC7981_PIN('E', 4), LC7981_PIN('E', 5),
+	LC7981_PIN('G', 5), LC7981_PIN('E', 3), LC7981_PIN('H', 3), LC7981_PIN('H', 4),
+	LC7981_PIN('H', 5), LC7981_PIN('H', 6), LC7981_PIN('B', 4), LC7981_PIN('B', 5),
+	LC7981_PIN('B', 6), LC7981_PIN('B', 7), LC7981_PIN('J', 1), LC7981_PIN('J', 0),
+	LC7981_PIN('H', 1), LC7981_PIN('H', 0), LC7981_PIN('D', 3), LC7981_PIN('D', 2),
+	LC7981_PIN('D', 1), LC7981_PIN('D', 0), LC7981_PIN('A', 0), LC7981_PIN('A', 1),
+	LC7981_PIN('A', 2), LC7981_PIN('A', 3), LC7981_PIN('A', 4), LC7981_PIN('A', 5),
+	LC7981_PIN('A', 6), LC7981_PIN('A', 7), LC7981_PIN('C', 7), LC7981_PIN('C', 6),
+	LC7981_PIN('C', 5), LC7981_PIN('C', 4), LC7981_PIN('C', 3), LC7981_PIN('C', 2),
+	LC7981_PIN('C', 1), LC7981_PIN('C', 0), LC7981_PIN('D', 7), LC7981_PIN('G', 2),
+	LC7981_PIN('G', 1), LC7981_PIN('G', 0), LC7981_PIN('L', 7), LC7981_PIN('L', 6),
+	LC7981_PIN('L', 5), LC7981_PIN('L', 4), LC7981_PIN('L', 3), LC7981_PIN('L', 2),
+	LC7981_PIN('L', 1), LC7981_PIN('L', 0), LC7981_PIN('B', 3), LC7981_PIN('B', 2),
+	LC7981_PIN('B', 1), LC7981_PIN('B', 0),
+	LC7981_PIN('F', 0), LC7981_PIN('F', 1), LC7981_PIN('F', 2), LC7981_PIN('F', 3),
+	LC7981_PIN('F', 4), LC7981_PIN('F', 5), LC7981_PIN('F', 6), LC7981_PIN('F', 7),
+	LC7981_PIN('K', 0), LC7981_PIN('K', 1), LC7981_PIN('K', 2), LC7981_PIN('K', 3),
+	LC7981_PIN('K', 4), LC7981_PIN('K', 5), LC7981_PIN('K', 6), LC7981_PIN('K', 7),
+};
+#else
+#define LC7981_NO_FAST_PINS_TABLE
+#endif
+#undef LC7981_PIN
+
+/// Port registers, by port index (A = 0, B = 1 and so on). Ports are marked 
+/// `atomic` if single bits can be changed by `sbi`/`cbi` instructions, 
+/// otherwise interrupts are disabled for read-modify-write.
+template <uint8_t index>
+struct FastPort;
+#define LC7981_FAST_PORT(letter, index, isAtomic) \
+	template <> \
+	struct FastPort<index> \
+	{ \
+		static constexpr bool atomic = isAtomic; \
+		static inline volatile uint8_t& out() { return PORT##letter; } \
+		static inline volatile uint8_t& in()  { return PIN##letter; } \
+		static inline volatile uint8_t& dir() { return DDR##letter; } \
+	};
+#ifdef PORTA
+LC7981_FAST_PORT(A, 0, true)
+#endif
+#ifdef PORTB
+LC7981_FAST_PORT(B, 1, true)
+#endif
+#ifdef PORTC
+LC7981_FAST_PORT(C, 2, true)
+#endif
+#ifdef PORTD
+LC7981_FAST_PORT(D, 3, true)
+#endif
+#ifdef PORTE
+LC7981_FAST_PORT(E, 4, true)
+#endif
+#ifdef PORTF
+LC7981_FAST_PORT(F, 5, true)
+#endif
+#ifdef PORTG
+LC7981_FAST_PORT(G, 6, true)
+#endif
+#ifdef PORTH
+LC7981_FAST_PORT(H, 7, false)
+#endif
+#ifdef PORTJ
+LC7981_FAST_PORT(J, 9, false)
+#endif
+#ifdef PORTK
+LC7981_FAST_PORT(K, 10, false)
+#endif
+#ifdef PORTL
+LC7981_FAST_PORT(L, 11, false)
+#endif
+#undef LC7981_FAST_PORT
 
-			// Read background for first block if not aligned start
-			if (bitsOffset) {
-				setCursorAddress(width / 8 * y + x / 8);
-				nextByte = (readSingleByte() & ~(0b11111111 << bitsOffset));
-				bitsPending = bitsOffset;
+/// Pins IO using port registers directly, with Arduino pins resolved to ports
+/// and bits in compile-time using `fastPinsTable`, so each pin operation gets
+/// down to single instruction (`sbi`/`cbi`/`sbic` in most cases). Only known
+/// boards are supported (see the table), otherwise use `ArduinoIO`.
+struct FastIO
+{
+	/// Minimal CPU cycles spent by pin write (`sbi`/`cbi`) and read (`in`).
+	static constexpr uint8_t pinWriteCycles = 2;
+	static constexpr uint8_t pinReadCycles = 1;
+
+	/// Data bus IO, using shifted masked stores if possible (see below).
+	template <
+		uint8_t DB0, uint8_t DB1, uint8_t DB2, uint8_t DB3,
+		uint8_t DB4, uint8_t DB5, uint8_t DB6, uint8_t DB7
+	>
+	struct DataBus;
+
+	template <uint8_t pin>
+	struct Pin
+	{
+#ifdef LC7981_NO_FAST_PINS_TABLE
+		static_assert(pin != pin, "Pins mapping for FastIO is unknown for the board, use ArduinoIO.");
+#else
+		static_assert(pin < sizeof(fastPinsTable), "Pin not supported by FastIO on the board.");
+
+		using Port = FastPort<(fastPinsTable[pin] >> 3)>;
+		static constexpr uint8_t mask = 1 << (fastPinsTable[pin] & 0b111);
+
+		static inline void high()
+		{
+			if (Port::atomic) {
+				Port::out() |= mask;
+			}
+			else {
+				const uint8_t oldSREG = SREG;
+				cli();
+				Port::out() |= mask;
+				SREG = oldSREG;
 			}
+		}
 
-			// Process next blocks
-			setCursorAddress(width / 8 * y + x / 8);
-			writeStart();
-			while (*pointer) {
-				const uint8_t data = pgm_read_byte(fontData + (*pointer - ' ') * fontRowBytes + r); // & mask
+		static inline void low()
+		{
+			if (Port::atomic) {
+				Port::out() &= ~mask;
+			}
+			else {
+				const uint8_t oldSREG = SREG;
+				cli();
+				Port::out() &= ~mask;
+				SREG = oldSREG;
+			}
+		}
 
-				nextByte |= data << bitsPending;
-				bitsPending += fontWidth;
+		static inline void write(const bool value)
+		{
+			if (value) {
+				high();
+			}
+			else {
+				low();
+			}
+		}
 
-				if (bitsPending >= 8) {
-					writeNextByte(nextByte);
-					bitsPending -= 8;
-					nextByte = data >> (fontWidth - bitsPending);
-				}
+		static inline bool read()
+		{
+			return Port::in() & mask;
+		}
 
-				pointer += 1;
+		static inline void output()
+		{
+			if (Port::atomic) {
+				Port::dir() |= mask;
+			}
+			else {
+				const uint8_t oldSREG = SREG;
+				cli();
+				Port::dir() |= mask;
+				SREG = oldSREG;
 			}
+		}
 
-			// Write last block, with background, if not aligned end
-			if (bitsPending > 0) {
-				nextByte |= readSingleByte() & (0b11111111 << bitsPending);
-				const uint8_t widthTotal = static_cast<size_t>(pointer - string) * fontWidth + bitsOffset;
-				setCursorAddress(width / 8 * y + x / 8 + widthTotal / 8);
-				writeStart();
-				writeNextByte(nextByte);
+		static inline void input()
+		{
+			// Normal input (no pull-up)
+			low();
+			if (Port::atomic) {
+				Port::dir() &= ~mask;
+			}
+			else {
+				const uint8_t oldSREG = SREG;
+				cli();
+				Port::dir() &= ~mask;
+				SREG = oldSREG;
 			}
+		}
+#endif
+	};
+};
 
-			y += 1;
+#ifdef LC7981_NO_FAST_PINS_TABLE
+template <
+	uint8_t DB0, uint8_t DB1, uint8_t DB2, uint8_t DB3,
+	uint8_t DB4, uint8_t DB5, uint8_t DB6, uint8_t DB7
+>
+struct FastIO::DataBus : PinsDataBus<FastIO, DB0, DB1, DB2, DB3, DB4, DB5, DB6, DB7>
+{};
+#else
+/// Checks if second pin is the next bit of the same port as first pin.
+constexpr bool fastPinsFollow(const uint8_t first, const uint8_t second)
+{
+	return (fastPinsTable[first] & 0b111) != 0b111 && fastPinsTable[second] == fastPinsTable[first] + 1;
+}
+
+/// Counts pins forming contiguous run (following bits of the same port), 
+/// going forwards or backwards through the list of pins.
+constexpr uint8_t fastPinsRunLength(const bool /*backwards*/, const uint8_t /*pin*/)
+{
+	return 1;
+}
+template <typename... Pins>
+constexpr uint8_t fastPinsRunLength(const bool backwards, const uint8_t pin, const uint8_t next, Pins... pins)
+{
+	return (backwards ? fastPinsFollow(next, pin) : fastPinsFollow(pin, next)) 
+		? 1 + fastPinsRunLength(backwards, next, pins...) : 1;
+}
+
+/// Data bus IO for `FastIO`. If data pins form at most two contiguous runs
+/// (following bits of a port, like PD2..PD7 and PC2..PC3), whole byte is 
+/// read or written by one or two shifted, masked accesses, otherwise it falls
+/// back to going pin by pin. Layout is detected in compile-time.
+template <
+	uint8_t DB0, uint8_t DB1, uint8_t DB2, uint8_t DB3,
+	uint8_t DB4, uint8_t DB5, uint8_t DB6, uint8_t DB7
+>
+struct FastIO::DataBus
+{
+	using PerPin = PinsDataBus<FastIO, DB0, DB1, DB2, DB3, DB4, DB5, DB6, DB7>;
+
+	// Low run starts at DB0, high run ends at DB7 (empty if single run).
+	static constexpr uint8_t lowLength = fastPinsRunLength(false, DB0, DB1, DB2, DB3, DB4, DB5, DB6, DB7);
+	static constexpr uint8_t highLength = 8 - lowLength;
+	static constexpr bool contiguous = 
+		lowLength + fastPinsRunLength(true, DB7, DB6, DB5, DB4, DB3, DB2, DB1, DB0) >= 8;
+
+	using LowPort = FastPort<(fastPinsTable[DB0] >> 3)>;
+	using HighPort = FastPort<(fastPinsTable[DB7] >> 3)>;
+	static constexpr uint8_t lowShift = fastPinsTable[DB0] & 0b111;
+	static constexpr uint8_t highShift = contiguous && highLength 
+		? (fastPinsTable[DB7] & 0b111) + 1 - highLength : 0;
+	static constexpr uint8_t lowMask = ((1 << lowLength) - 1) << lowShift;
+	static constexpr uint8_t highMask = ((1 << highLength) - 1) << highShift;
+
+	/// Sets masked bits of the register to the value. Interrupts need to be
+	/// disabled by caller, unless the mask covers whole register.
+	static inline void store(volatile uint8_t& reg, const uint8_t mask, const uint8_t value)
+	{
+		if (mask == 0xFF) {
+			reg = value;
+		}
+		else {
+			reg = (reg & ~mask) | (value & mask);
 		}
 	}
 
-	/// Draw text vertically using selected font, assuming font width is above 8 bits.
-	/// Font chars rows bits should be connected and padded only to avoid mixing characters.
-	void drawTextVertical_wide(const uint8_t x, uint8_t y, const char* string, const void* font) {
-		const auto fontWidth  = static_cast<const font_header_t*>(font)->width;
-		const auto fontHeight = static_cast<const font_header_t*>(font)->height;
-		const uint8_t* fontData = static_cast<const uint8_t*>(font + sizeof(font_header_t));
-		const uint8_t fontRowBytes = (fontWidth * fontHeight + 7) / 8;
-		const uint8_t bitsOffset = x % 8;
-		const char* pointer;
-		for (uint8_t r = 0; r < fontHeight; r++) {
-			pointer = string;
+	static inline void storeBoth(
+		volatile uint8_t& lowReg, volatile uint8_t& highReg, 
+		const uint8_t value
+	) {
+		if (lowMask == 0xFF) {
+			store(lowReg, lowMask, value);
+		}
+		else {
+			const uint8_t oldSREG = SREG;
+			cli();
+			store(lowReg, lowMask, value << lowShift);
+			if (highLength) {
+				store(highReg, highMask, (value >> lowLength) << highShift);
+			}
+			SREG = oldSREG;
+		}
+	}
 
-			uint8_t bitsPending = 0; // to be written
-			uint8_t nextByte = 0; // buffer for bits to be yet written
+	static inline void input()
+	{
+		if (contiguous) {
+			// Normal input (no pull-up)
+			storeBoth(LowPort::out(), HighPort::out(), 0);
+			storeBoth(LowPort::dir(), HighPort::dir(), 0);
+		}
+		else {
+			PerPin::input();
+		}
+	}
 
-			// Read background for first block if not aligned start
-			if (bitsOffset) {
-				setCursorAddress(width / 8 * y + x / 8);
-				nextByte = (readSingleByte() & ~(0b11111111 << bitsOffset));
-				bitsPending = bitsOffset;
-			}
+	static inline void output()
+	{
+		if (contiguous) {
+			storeBoth(LowPort::dir(), HighPort::dir(), 0xFF);
+		}
+		else {
+			PerPin::output();
+		}
+	}
 
-			const uint8_t rowOffsetByte = r * fontWidth / 8;
-			const uint8_t rowOffsetBits = r * fontWidth % 8;
+	static inline uint8_t read()
+	{
+		if (contiguous) {
+			uint8_t out = (LowPort::in() & lowMask) >> lowShift;
+			if (highLength) {
+				out |= ((HighPort::in() & highMask) >> highShift) << lowLength;
+			}
+			return out;
+		}
+		else {
+			return PerPin::read();
+		}
+	}
 
-			// Process next blocks
-			setCursorAddress(width / 8 * y + x / 8);
-			writeStart();
-			while (*pointer) {
-				uint8_t remainingFontWidth = fontWidth;
-				const uint8_t* charAddress = fontData + (*pointer - ' ') * fontRowBytes;
-				uint8_t byteOffset;
+	static inline void write(const uint8_t in)
+	{
+		if (contiguous) {
+			storeBoth(LowPort::out(), HighPort::out(), in);
+		}
+		else {
+			PerPin::write(in);
+		}
+	}
+};
+#endif
 
-				// TODO: use lambda to reduce program size a bit?
+#endif // __AVR__
 
-				// Partial first byte 
-				if (rowOffsetBits) {
-					const uint8_t data = pgm_read_byte(charAddress + rowOffsetByte) >> rowOffsetBits;
-					const uint8_t length = 8 - rowOffsetBits;
 
-					nextByte |= data << bitsPending;
-					bitsPending += length;
-					remainingFontWidth -= length;
 
-					if (bitsPending >= 8) {
-						writeNextByte(nextByte);
-						bitsPending -= 8;
-						nextByte = data >> (length - bitsPending);
-					}
+/// Bus timing using fixed delays from datasheet around each EN strobe, 
+/// assuming the controller is always ready for next access. Delays are
+/// exact CPU cycles for `F_CPU`, minus cycles spent by the pin operations
+/// of given pins IO (EN change, data bus read).
+template <class IO = ArduinoIO>
+struct FixedTiming
+{
+	/// Whether to poll busy flag before each access.
+	static constexpr bool pollBusy = false;
 
-					byteOffset = 1;
-				}
-				else /* first byte is full too */ {
-					byteOffset = 0;
-				}
+	/// Wait address/control set-up time (90ns).
+	static inline void setup()
+	{
+		delayNanoseconds<90, IO::pinWriteCycles>();
+	}
 
-				// Full bytes
-				while (remainingFontWidth > 8) {
-					const uint8_t data = pgm_read_byte(charAddress + rowOffsetByte + byteOffset);
+	/// Wait data delay time (reading, 140ns).
+	static inline void readDelay()
+	{
+		delayNanoseconds<140, IO::pinReadCycles>();
+	}
 
-					nextByte |= data << bitsPending;
-					writeNextByte(nextByte);
-					remainingFontWidth -= 8;
-					nextByte = data >> (8 - bitsPending);
+	/// Wait data set-up time (writing, 220ns).
+	static inline void writeDelay()
+	{
+		delayNanoseconds<220, IO::pinWriteCycles>();
+	}
 
-					byteOffset += 1;
-				}
+	/// Set timing level, not supported by fixed timing.
+	static inline bool setLevel(const uint8_t /*level*/)
+	{
+		return false;
+	}
+};
 
-				// Last bits
-				{
-					const uint8_t data = pgm_read_byte(charAddress + rowOffsetByte + byteOffset) 
-						& ~(static_cast<uint8_t>(0b11111111) << remainingFontWidth);
+/// Bus timing polling busy flag (DB7 on status read) instead of waiting 
+/// for the controller to finish internal operation. The flag is polled only
+/// before access following data register access (display data, or
+/// instruction parameter, which starts the execution), not after writing
+/// instruction code. Set-up, data delay and EN pulse times of single 
+/// access are kept as in `FixedTiming`, as the busy flag doesn't relax
+/// them (`delayNanoseconds` subtracts only the cycles the IO declares to
+/// spend, none for `ArduinoIO`, so there the full delays are waited on each
+/// access). Bursts fall back to single accesses, as each data write makes
+/// the controller busy, and polling changes the control lines.
+///
+/// Polling is not free: each poll is status read, switching data bus to 
+/// input and back to output for next write (16 `pinMode` calls with 
+/// `ArduinoIO`, so many times more of them than with fixed timing). It pays
+/// off only if the IO is fast compared to the controller operations, so 
+/// compare both (testing example `$` command).
+template <class IO = ArduinoIO>
+struct BusyFlagTiming
+{
+	static constexpr bool pollBusy = true;
 
-					nextByte |= data << bitsPending;
-					bitsPending += remainingFontWidth;
+	/// Wait address/control set-up time (90ns).
+	static inline void setup()
+	{
+		delayNanoseconds<90, IO::pinWriteCycles>();
+	}
 
-					if (bitsPending >= 8) {
-						writeNextByte(nextByte);
-						bitsPending -= 8;
-						nextByte = data >> (remainingFontWidth - bitsPending);
-					}
-				}
+	/// Wait data delay time (reading, 140ns).
+	static inline void readDelay()
+	{
+		delayNanoseconds<140, IO::pinReadCycles>();
+	}
 
-				pointer += 1;
-			}
+	/// Wait data set-up time (writing, 220ns).
+	static inline void writeDelay()
+	{
+		delayNanoseconds<220, IO::pinWriteCycles>();
+	}
 
-			// Write last block, with background, if not aligned end
-			if (bitsPending > 0) {
-				nextByte |= readSingleByte() & (0b11111111 << bitsPending);
-				const uint8_t widthTotal = static_cast<size_t>(pointer - string) * fontWidth + bitsOffset;
-				setCursorAddress(width / 8 * y + x / 8 + widthTotal / 8);
-				writeStart();
-				writeNextByte(nextByte);
-			}
+	static inline bool setLevel(const uint8_t /*level*/)
+	{
+		return false;
+	}
+};
 
-			y += 1;
-		}
+/// Bus timing with delays scaled in runtime by timing level, from datasheet 
+/// delays for `fullTimingLevel` down to no delays for level 0. The level is 
+/// usually selected by display `calibrateTiming`. Delays are done by loop 
+/// taking 3 cycles per iteration, rounded up.
+template <class IO = ArduinoIO>
+class CalibratedTiming
+{
+	uint8_t setupLoops;
+	uint8_t readLoops;
+	uint8_t writeLoops;
+
+	/// Number of delay loop iterations for given time at given level.
+	static inline uint8_t loops(
+		const uint32_t cycles, const uint8_t spentCycles, const uint8_t level
+	) {
+		const uint32_t scaled = (cycles * level + fullTimingLevel - 1) / fullTimingLevel;
+		return scaled > spentCycles ? (scaled - spentCycles + 2) / 3 : 0;
 	}
 
-	/// Draw text vertically using selected font
-	void drawTextVertical(const uint8_t x, const uint8_t y, const char* string, const void* font) {
-		const auto fontWidth  = static_cast<const font_header_t*>(font)->width;
-		const auto fontHeight = static_cast<const font_header_t*>(font)->height;
-#ifdef FONT_ANY_8X16
-		if (fontWidth == 8 && fontHeight == 16) {
-			return drawTextVertical_8x16(x, y, string, font);
-		}
+	static inline void delayLoops(const uint8_t count)
+	{
+		if (count) {
+#ifdef __AVR__
+			_delay_loop_1(count);
+#else
+			delayMicroseconds(1);
 #endif
-		if (fontWidth <= 8) {
-			return drawTextVertical_narrow(x, y, string, font);
-		}
-		else {
-			return drawTextVertical_wide(x, y, string, font);
 		}
 	}
+
+public:
+	static constexpr bool pollBusy = false;
+
+	CalibratedTiming()
+	{
+		setLevel(fullTimingLevel);
+	}
+
+	inline void setup()
+	{
+		delayLoops(setupLoops);
+	}
+
+	inline void readDelay()
+	{
+		delayLoops(readLoops);
+	}
+
+	inline void writeDelay()
+	{
+		delayLoops(writeLoops);
+	}
+
+	bool setLevel(const uint8_t level)
+	{
+		setupLoops = loops(nanosecondsToCycles(90), IO::pinWriteCycles, level);
+		readLoops = loops(nanosecondsToCycles(140), IO::pinReadCycles, level);
+		writeLoops = loops(nanosecondsToCycles(220), IO::pinWriteCycles, level);
+		return true;
+	}
 };
 
 
 
-/// Display class using compilation-time defined pins for all IO, including data bus.
-/// Note: It might use a bit slow mapping function, but should work for all 
-/// boards and core. There is room for improvements, but currently Arduino team
-/// don't want to use compile-time mappings inside main core in fear of 
-/// incompatibility to other 3rd party cores. 
+/// Bus using compilation-time defined pins for all IO, including data bus.
+/// Note: By default (`ArduinoIO`) it uses a bit slow mapping function, but 
+/// should work for all boards and core. There is room for improvements, but 
+/// currently Arduino team don't want to use compile-time mappings inside main
+/// core in fear of incompatibility to other 3rd party cores. 
 /// See https://github.com/arduino/ArduinoCore-avr/issues/264 (and related issues).
-/// See `fastio_example.hpp` for example how to use faster IO.
+/// For known boards, `FastIO` can be used to resolve pins in compile-time.
+/// See `fastio_example.hpp` for example how to use faster IO by hand.
 template <
 	// Enable: HIGH -> LOW enables
 	uint8_t EN,
@@ -728,179 +2965,590 @@ template <
 	// you can use the data pins between operations on display for other stuff,
 	// possibly also other display (that use only other control ports).
 	// Its true for default, as it allow to increase code efficiency.
-	bool chipAlwaysSelected = true
+	bool chipAlwaysSelected = true,
+	// Pins IO implementation, see `ArduinoIO` and `FastIO`.
+	class IO = ArduinoIO,
+	// Bus timing policy, see `FixedTiming`, `BusyFlagTiming` and `CalibratedTiming`.
+	class Timing = FixedTiming<IO>
 >
-class DisplayByPins : public DisplayBase
+class PinsBus : public BusBase<PinsBus<
+	EN, CS, RS, RW, 
+	DB0, DB1, DB2, DB3, DB4, DB5, DB6, DB7, 
+	chipAlwaysSelected, IO, Timing
+>>, protected Timing
 {
+public:
+	/// Reading costs 3 data writes, counted in pin operations with data pins
+	/// accessed one by one (`ArduinoIO`, or `FastIO` with scattered pins).
+	/// Data write takes 13: control lines (3), data pins (8) and EN (2).
+	/// Read (dummy and actual, as burst) takes 39: control lines (3), data 
+	/// pins switched to input (8), two strobes reading pins (2 * 10) and 
+	/// switching pins back to output (8) before next write, as in practice 
+	/// reads are always followed by writes (read-modify-write). With data 
+	/// bus on contiguous port bits it comes closer to 2, so bit operations 
+	/// limit (see `BasicDisplay`) is slightly in favour of bit operations.
+	static constexpr uint8_t readCost = 3;
+
+	/// Whether busy flag is polled before accesses, as timing policy says.
+	static constexpr bool pollBusy = Timing::pollBusy;
+
 protected:
+	template <uint8_t pin>
+	using Pin = typename IO::template Pin<pin>;
+
+	using DataBus = typename IO::template DataBus<DB0, DB1, DB2, DB3, DB4, DB5, DB6, DB7>;
+
 	inline void setDataBusAsInput()
 	{
-		pinMode(DB0, INPUT);
-		pinMode(DB1, INPUT);
-		pinMode(DB2, INPUT);
-		pinMode(DB3, INPUT);
-		pinMode(DB4, INPUT);
-		pinMode(DB5, INPUT);
-		pinMode(DB6, INPUT);
-		pinMode(DB7, INPUT);
+		DataBus::input();
 	}
 
 	inline void setDataBusAsOutput()
 	{
-		pinMode(DB0, OUTPUT);
-		pinMode(DB1, OUTPUT);
-		pinMode(DB2, OUTPUT);
-		pinMode(DB3, OUTPUT);
-		pinMode(DB4, OUTPUT);
-		pinMode(DB5, OUTPUT);
-		pinMode(DB6, OUTPUT);
-		pinMode(DB7, OUTPUT);
+		DataBus::output();
 	}
 
 	inline uint8_t readDataBus()
 	{
-		uint8_t out = 0;
-		out |= (digitalRead(DB0) << 0);
-		out |= (digitalRead(DB1) << 1);
-		out |= (digitalRead(DB2) << 2);
-		out |= (digitalRead(DB3) << 3);
-		out |= (digitalRead(DB4) << 4);
-		out |= (digitalRead(DB5) << 5);
-		out |= (digitalRead(DB6) << 6);
-		out |= (digitalRead(DB7) << 7);
-		return out;
+		return DataBus::read();
 	}
 
 	inline void writeDataBus(const uint8_t in)
 	{
-		digitalWrite(DB0, (in >> 0) & 1);
-		digitalWrite(DB1, (in >> 1) & 1);
-		digitalWrite(DB2, (in >> 2) & 1);
-		digitalWrite(DB3, (in >> 3) & 1);
-		digitalWrite(DB4, (in >> 4) & 1);
-		digitalWrite(DB5, (in >> 5) & 1);
-		digitalWrite(DB6, (in >> 6) & 1);
-		digitalWrite(DB7, (in >> 7) & 1);
+		DataBus::write(in);
 	}
 
 	inline void selectChip()
 	{
-		if (!chipAlwaysSelected || CS == NOT_A_PIN) {
+		if (!chipAlwaysSelected && CS != NOT_A_PIN) {
 			// // Fake read without chip enable might be required
-			// digitalWrite(CS, HIGH);
-			// digitalWrite(RW, LOW);
-			// digitalWrite(EN, HIGH);
-			// digitalWrite(EN, LOW);
+			// Pin<CS>::write(HIGH);
+			// Pin<RW>::write(LOW);
+			// Pin<EN>::write(HIGH);
+			// Pin<EN>::write(LOW);
 
-			digitalWrite(CS, LOW);
+			Pin<CS>::write(LOW);
 		}
 	}
 
 	inline void deselectChip()
 	{
-		if (!chipAlwaysSelected || CS == NOT_A_PIN) {
-			digitalWrite(CS, HIGH);
+		if (!chipAlwaysSelected && CS != NOT_A_PIN) {
+			Pin<CS>::write(HIGH);
 		}
 	}
 
-	uint8_t read(const register_t reg) override
+	/// Current direction of data bus, switched only when access type changes.
+	bool dataBusIsInput = false;
+
+	/// Prepare data bus for reading, if not prepared already.
+	inline void useDataBusAsInput()
 	{
-		digitalWrite(EN, LOW);
-		
-		// Data bus is input only inside `read`, as writes are more common.
-		setDataBusAsInput();
+		if (!dataBusIsInput) {
+			dataBusIsInput = true;
+			setDataBusAsInput();
+		}
+	}
+
+	/// Prepare data bus for writing, if not prepared already.
+	inline void useDataBusAsOutput()
+	{
+		if (dataBusIsInput) {
+			dataBusIsInput = false;
+			setDataBusAsOutput();
+		}
+	}
+
+	/// Release data bus after reading, if chip is not always selected, as 
+	/// the pins might be used by other stuff expecting bus left as output.
+	inline void releaseDataBusAfterRead()
+	{
+		if (!chipAlwaysSelected) {
+			useDataBusAsOutput();
+		}
+	}
+
+	/// Select chip and set control lines for writing to given register.
+	inline void setupWrite(const register_t reg)
+	{
+		Pin<EN>::write(LOW);
+		selectChip();
+		Pin<RW>::write(LOW);
+		Pin<RS>::write(reg);
+		useDataBusAsOutput();
+	}
 
+	/// Select chip and set control lines for reading from given register.
+	inline void setupRead(const register_t reg)
+	{
+		Pin<EN>::write(LOW);
+		useDataBusAsInput();
 		selectChip();
-		digitalWrite(RW, HIGH);
-		digitalWrite(RS, reg);
+		Pin<RW>::write(HIGH);
+		Pin<RS>::write(reg);
+	}
 
-		// Wait set-up time
-		_delay_us(0.090);
+	/// Strobe EN and read byte from data bus, assuming control lines are set.
+	inline uint8_t strobeRead()
+	{
+		Timing::setup();
 
-		digitalWrite(EN, HIGH);
+		Pin<EN>::write(HIGH);
 
-		// Wait data delay time (reading)
-		_delay_us(0.140);
+		Timing::readDelay();
 
 		uint8_t out = readDataBus();
 
-		digitalWrite(EN, LOW);
+		Pin<EN>::write(LOW);
 
-		deselectChip();
+		return out;
+	}
 
-		setDataBusAsOutput();
+	/// Put byte on data bus and strobe EN, assuming control lines are set.
+	inline void strobeWrite(const uint8_t value)
+	{
+		writeDataBus(value);
+
+		Timing::setup();
+
+		Pin<EN>::write(HIGH);
 
+		Timing::writeDelay();
+
+		Pin<EN>::write(LOW);
+	}
+
+	/// Whether the controller might be busy, after data register access.
+	/// Writing instruction code doesn't start any internal operation.
+	bool mayBeBusy = true;
+
+	/// Wait until controller is ready for next access to given register, if
+	/// timing policy polls busy flag and the controller might be busy.
+	inline void waitReady(const register_t reg)
+	{
+		if (Timing::pollBusy) {
+			if (mayBeBusy) {
+				waitBusy();
+			}
+			mayBeBusy = reg == Data;
+		}
+	}
+
+	/// Flag for burst of data writes, while chip is kept selected and 
+	/// control lines are kept set, so only data bus and EN are changed.
+	bool inWriteBurst = false;
+
+public:
+	uint8_t read(const register_t reg)
+	{
+		waitReady(reg);
+		setupRead(reg);
+		uint8_t out = strobeRead();
+		deselectChip();
+		releaseDataBusAfterRead();
 		return out;
 	}
 
-	void write(const register_t reg, const uint8_t value) override
+	void readBytes(uint8_t* data, uint16_t length)
+	{
+		if (Timing::pollBusy) {
+			while (length--) {
+				*data++ = read(Data);
+			}
+			return;
+		}
+		if (!length) return;
+		setupRead(Data);
+		while (length--) {
+			*data++ = strobeRead();
+		}
+		deselectChip();
+		releaseDataBusAfterRead();
+	}
+
+	void write(const register_t reg, const uint8_t value)
 	{
-		digitalWrite(EN, LOW);
+		if (inWriteBurst) {
+			// Only data register writes are expected inside the burst.
+			strobeWrite(value);
+			return;
+		}
 
-		writeDataBus(value);
+		waitReady(reg);
+		setupWrite(reg);
+		strobeWrite(value);
+		deselectChip();
+	}
 
-		selectChip();
-		digitalWrite(RW, LOW);
-		digitalWrite(RS, reg);
+	void writeRegister(const uint8_t instruction, const uint8_t value)
+	{
+		if (Timing::pollBusy) {
+			write(Command, instruction);
+			write(Data, value);
+			return;
+		}
+		setupWrite(Command);
+		strobeWrite(instruction);
+		// Only register select changes, while EN is low
+		Pin<RS>::write(Data);
+		strobeWrite(value);
+		deselectChip();
+	}
+
+	void writeBytes(const uint8_t* data, uint16_t length)
+	{
+		if (Timing::pollBusy) {
+			while (length--) {
+				write(Data, *data++);
+			}
+			return;
+		}
+		if (!inWriteBurst) {
+			setupWrite(Data);
+		}
+		while (length--) {
+			strobeWrite(*data++);
+		}
+		if (!inWriteBurst) {
+			deselectChip();
+		}
+	}
+
+	void writeRepeat(const uint8_t value, uint16_t count)
+	{
+		if (Timing::pollBusy) {
+			while (count--) {
+				write(Data, value);
+			}
+			return;
+		}
+		if (!count) return;
+		if (!inWriteBurst) {
+			setupWrite(Data);
+		}
+		// Data bus stays the same, so only EN needs to be strobed.
+		strobeWrite(value);
+		while (--count) {
+			Timing::setup();
+
+			Pin<EN>::write(HIGH);
+
+			Timing::writeDelay();
 
-		// Wait set-up time
-		_delay_us(0.090);
+			Pin<EN>::write(LOW);
+		}
+		if (!inWriteBurst) {
+			deselectChip();
+		}
+	}
 
-		digitalWrite(EN, HIGH);
+	bool setTimingLevel(const uint8_t level)
+	{
+		return Timing::setLevel(level);
+	}
 
-		// Wait data set-up time (writing)
-		_delay_us(0.220);
+	void beginWriteBurst()
+	{
+		if (Timing::pollBusy) return;
+		setupWrite(Data);
+		inWriteBurst = true;
+	}
 
-		digitalWrite(EN, LOW);
+	void endWriteBurst()
+	{
+		if (Timing::pollBusy) return;
+		inWriteBurst = false;
 		deselectChip();
 	}
 
-	void init() override
+	void init()
 	{
-		pinMode(EN, OUTPUT);
-		digitalWrite(EN, LOW);
+		Pin<EN>::output();
+		Pin<EN>::write(LOW);
 
-		pinMode(RS, OUTPUT);
-		pinMode(RW, OUTPUT);
+		Pin<RS>::output();
+		Pin<RW>::output();
 
 		if (CS != NOT_A_PIN) {
-			pinMode(CS, OUTPUT);
+			Pin<CS>::output();
 			if (chipAlwaysSelected) {
-				digitalWrite(CS, LOW);
+				Pin<CS>::write(LOW);
 			}
 			else {
-				digitalWrite(CS, HIGH);
+				Pin<CS>::write(HIGH);
 			}
 		}
 
 		setDataBusAsOutput();
+		dataBusIsInput = false;
+		mayBeBusy = true;
 	}
 
 	void waitBusy()
 	{
-		setDataBusAsInput();
-		selectChip();
-		digitalWrite(RW, HIGH);
-		digitalWrite(RS, HIGH);
+		setupRead(Command);
 
 		while (true) {
-			digitalWrite(EN, LOW);
+			Timing::setup();
 
-			// Wait set-up time
-			_delay_us(0.090);
+			Pin<EN>::write(HIGH);
 
-			digitalWrite(EN, HIGH);
+			Timing::readDelay();
 
-			// Wait data delay time (reading)
-			_delay_us(0.140);
+			const bool busy = Pin<DB7>::read();
 
-			if (!digitalRead(DB7)) {
+			Pin<EN>::write(LOW);
+
+			if (!busy) {
 				break;
 			}
 		}
+
+		deselectChip();
+		releaseDataBusAfterRead();
+		mayBeBusy = false;
 	}
 };
 
+/// Display class using compilation-time defined pins for all IO, including data bus.
+/// See `PinsBus` for details about the template parameters.
+template <
+	uint8_t EN, uint8_t CS, uint8_t RS, uint8_t RW,
+	uint8_t DB0, uint8_t DB1, uint8_t DB2, uint8_t DB3,
+	uint8_t DB4, uint8_t DB5, uint8_t DB6, uint8_t DB7,
+	bool chipAlwaysSelected = true
+>
+using DisplayByPins = BasicDisplay<PinsBus<
+	EN, CS, RS, RW, 
+	DB0, DB1, DB2, DB3, DB4, DB5, DB6, DB7, 
+	chipAlwaysSelected
+>>;
+
+#ifdef __AVR__
+/// Display class using compilation-time defined pins for all IO, including 
+/// data bus, resolved to ports and bits in compile-time (see `FastIO`).
+/// See `PinsBus` for details about the template parameters.
+template <
+	uint8_t EN, uint8_t CS, uint8_t RS, uint8_t RW,
+	uint8_t DB0, uint8_t DB1, uint8_t DB2, uint8_t DB3,
+	uint8_t DB4, uint8_t DB5, uint8_t DB6, uint8_t DB7,
+	bool chipAlwaysSelected = true
+>
+using FastDisplayByPins = BasicDisplay<PinsBus<
+	EN, CS, RS, RW, 
+	DB0, DB1, DB2, DB3, DB4, DB5, DB6, DB7, 
+	chipAlwaysSelected, FastIO
+>>;
+#endif
+
 
 
-}
+/// Bus for multiple displays sharing data bus and control lines, each with
+/// own chip select pin (`CS` list, in order of indexes used in selection
+/// mask). `Bus` drives the shared lines and should not select the chip itself,
+/// like `PinsBus` with `CS` set to `NOT_A_PIN` and `chipAlwaysSelected` false
+/// (it needs to provide `Pin` template, as `PinsBus` does).
+///
+/// Writes go to all selected displays at once (broadcast), so the same
+/// content can be drawn on all of them in single pass. Reads go only to the
+/// primary (first selected) display, so drawing requiring reads assumes
+/// the selected displays have the same content. Broadcasting is not allowed
+/// with timing policies polling the busy flag, as all selected displays 
+/// would drive the data bus while polling, so then only the first display
+/// of the selection mask is selected.
+template <class Bus, uint8_t... CS>
+class SharedBus : public Bus
+{
+	static_assert(sizeof...(CS) >= 1 && sizeof...(CS) <= 8, "Shared bus supports 1 to 8 displays.");
+
+public:
+	/// Number of displays sharing the bus.
+	static constexpr uint8_t count = sizeof...(CS);
+	/// Selection mask of all displays.
+	static constexpr uint8_t all = (1 << count) - 1;
+
+protected:
+	/// Mask of displays selected for next operations, all by default (first
+	/// one if polling busy flag).
+	uint8_t selection = Bus::pollBusy ? 1 : all;
+
+	/// Flag for burst of data writes, while selected chips are kept selected.
+	bool inWriteBurst = false;
+
+	/// Write chip select pins of displays in given mask.
+	inline void writeChipSelects(const uint8_t mask, const bool value)
+	{
+		uint8_t bit = 1;
+		const bool unused[] = {
+			(mask & bit ? Bus::template Pin<CS>::write(value) : void(), bit <<= 1, true)...
+		};
+		(void) unused;
+	}
+
+	/// Mask of primary (first selected) display, used for reading.
+	inline uint8_t primary() const
+	{
+		return selection & (~selection + 1);
+	}
+
+public:
+	/// Selection resulting from given mask of displays: only the first one
+	/// of them if polling busy flag, as broadcasting is not allowed then.
+	static inline uint8_t selectionOf(uint8_t mask)
+	{
+		mask &= all;
+		return Bus::pollBusy ? mask & (~mask + 1) : mask;
+	}
+
+	/// Select displays (mask of indexes) for next operations. Shouldn't be
+	/// called during write burst. If polling busy flag, only the first of 
+	/// the displays is selected (see `selectionOf`).
+	inline void select(const uint8_t mask)
+	{
+		selection = selectionOf(mask);
+	}
+
+	/// Mask of currently selected displays.
+	inline uint8_t selected() const
+	{
+		return selection;
+	}
+
+	uint8_t read(const register_t reg)
+	{
+		writeChipSelects(primary(), LOW);
+		const uint8_t out = Bus::read(reg);
+		writeChipSelects(primary(), HIGH);
+		return out;
+	}
+
+	void readBytes(uint8_t* data, uint16_t length)
+	{
+		writeChipSelects(primary(), LOW);
+		Bus::readBytes(data, length);
+		writeChipSelects(primary(), HIGH);
+	}
+
+	void write(const register_t reg, const uint8_t value)
+	{
+		if (inWriteBurst) {
+			Bus::write(reg, value);
+			return;
+		}
+		writeChipSelects(selection, LOW);
+		Bus::write(reg, value);
+		writeChipSelects(selection, HIGH);
+	}
+
+	void writeRegister(const uint8_t instruction, const uint8_t value)
+	{
+		writeChipSelects(selection, LOW);
+		Bus::writeRegister(instruction, value);
+		writeChipSelects(selection, HIGH);
+	}
+
+	void writeBytes(const uint8_t* data, uint16_t length)
+	{
+		if (inWriteBurst) {
+			Bus::writeBytes(data, length);
+			return;
+		}
+		writeChipSelects(selection, LOW);
+		Bus::writeBytes(data, length);
+		writeChipSelects(selection, HIGH);
+	}
+
+	void writeRepeat(const uint8_t value, uint16_t count)
+	{
+		if (inWriteBurst) {
+			Bus::writeRepeat(value, count);
+			return;
+		}
+		writeChipSelects(selection, LOW);
+		Bus::writeRepeat(value, count);
+		writeChipSelects(selection, HIGH);
+	}
+
+	void beginWriteBurst()
+	{
+		writeChipSelects(selection, LOW);
+		Bus::beginWriteBurst();
+		inWriteBurst = true;
+	}
+
+	void endWriteBurst()
+	{
+		if (!inWriteBurst) return;
+		inWriteBurst = false;
+		Bus::endWriteBurst();
+		writeChipSelects(selection, HIGH);
+	}
+
+	void init()
+	{
+		Bus::init();
+		const bool unused[] = {
+			(Bus::template Pin<CS>::output(), Bus::template Pin<CS>::write(HIGH), true)...
+		};
+		(void) unused;
+	}
+};
+
+/// Display class for multiple displays sharing the bus (see `SharedBus`),
+/// drawing on displays selected by `select`. All displays are selected by
+/// default, so `initGraphicMode` initializes all of them (unless polling busy
+/// flag, then each display needs to be selected and initialized in turn).
+template <class Bus, uint8_t... CS>
+class SharedDisplay : public BasicDisplay<SharedBus<Bus, CS...>>
+{
+	using Base = BasicDisplay<SharedBus<Bus, CS...>>;
+
+public:
+	using Base::Base;
+
+	/// Select displays (mask of indexes, bit 0 for first `CS`) to draw on.
+	/// Writes are broadcast to all selected displays, reads use first one.
+	/// If the bus polls busy flag, broadcasting is not allowed and only the
+	/// first display of the mask is selected (use `selectOnly` then).
+	void select(const uint8_t mask)
+	{
+		if (Base::selectionOf(mask) == Base::selected()) {
+			return;
+		}
+		// Ends burst, and forgets state kept for previously selected display
+		this->writeEnd();
+		this->invalidateCursor();
+		Base::select(mask);
+	}
+
+	/// Select single display to draw on.
+	inline void selectOnly(const uint8_t index)
+	{
+		select(1 << index);
+	}
+
+	/// Select all displays to draw on (broadcast).
+	inline void selectAll()
+	{
+		static_assert(!Base::pollBusy || Base::count == 1, "Broadcasting can't be used with busy flag polling.");
+		select(Base::all);
+	}
+};
+
+/// Multiple displays sharing compilation-time defined pins (all except chip
+/// select pins, listed as `CS`). See `SharedDisplay` and `PinsBus`.
+template <
+	uint8_t EN, uint8_t RS, uint8_t RW,
+	uint8_t DB0, uint8_t DB1, uint8_t DB2, uint8_t DB3,
+	uint8_t DB4, uint8_t DB5, uint8_t DB6, uint8_t DB7,
+	uint8_t... CS
+>
+using SharedDisplayByPins = SharedDisplay<PinsBus<
+	EN, NOT_A_PIN, RS, RW, 
+	DB0, DB1, DB2, DB3, DB4, DB5, DB6, DB7, 
+	false
+>, CS...>;
+
+
+
+}
\ No newline at end of file
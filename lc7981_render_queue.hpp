@@ -0,0 +1,216 @@
+#pragma once
+
+#include <Arduino.h>
+#include "lc7981.hpp"
+
+namespace LC7981
+{
+
+/// Encoded drawing operation, stored in `RenderQueue`.
+struct RenderOperation
+{
+	enum kind_t : uint8_t {
+		Clear,          // value: pattern
+		ClearGray,
+		Pixel,          // x, y, value: black
+		HorizontalLine, // x, y, a: length, value: pattern
+		VerticalLine,   // x, y, a: length, value: black
+		Line,           // x, y, a: x1, b: y1, value: black
+		Rectangle,      // x, y, a: width, b: height, value: black
+		Fill,           // x, y, a: width, b: height, value: black
+		GrayFill,       // x, y, a: width, b: height
+		PatternFill,    // x, y, a: width, b: height, data: pattern
+		TextVertical,   // x, y, data: string, font
+	};
+
+	uint8_t kind;
+	uint8_t x;
+	uint8_t y;
+	uint8_t a;
+	uint8_t b;
+	uint8_t value;
+	const void* data;
+	const void* font;
+
+	/// Replay the operation on given display (any `BasicDisplay`).
+	template <class Display>
+	void execute(Display& display) const
+	{
+		switch (kind) {
+			case Clear:
+				display.clear(value);
+				break;
+			case ClearGray:
+				display.clearGray();
+				break;
+			case Pixel:
+				display.setPixel(x, y, value);
+				break;
+			case HorizontalLine:
+				display.drawHorizontalLine(x, y, a, value);
+				break;
+			case VerticalLine:
+				if (value) {
+					display.drawBlackVerticalLine(x, y, a);
+				}
+				else {
+					display.drawWhiteVerticalLine(x, y, a);
+				}
+				break;
+			case Line:
+				display.drawLine(x, y, a, b, value);
+				break;
+			case Rectangle:
+				if (value) {
+					display.drawBlackRectangle(x, y, a, b);
+				}
+				else {
+					display.drawWhiteRectangle(x, y, a, b);
+				}
+				break;
+			case Fill:
+				if (value) {
+					display.drawBlackFill(x, y, a, b);
+				}
+				else {
+					display.drawWhiteFill(x, y, a, b);
+				}
+				break;
+			case GrayFill:
+				display.drawGrayFill(x, y, a, b);
+				break;
+			case PatternFill:
+				display.drawPatternFill(x, y, a, b, static_cast<const uint8_t*>(data));
+				break;
+			case TextVertical:
+				display.drawTextVertical(x, y, static_cast<const char*>(data), font);
+				break;
+		}
+	}
+};
+
+/// Single-producer single-consumer lock-free queue of drawing operations,
+/// allowing one thread or core (producer) to run the logic, while other one
+/// (consumer) owns the display bus and replays operations using `execute`.
+/// Producer methods only store the operation and return false if queue is
+/// full, never waiting for the display. Pointers (strings, patterns, fonts)
+/// need to stay valid until executed. `size` needs to be power of two.
+template <uint8_t size = 16>
+class RenderQueue
+{
+	static_assert(size >= 2 && (size & (size - 1)) == 0, "Queue size needs to be power of two.");
+
+protected:
+	RenderOperation operations[size];
+	/// Index of next operation to be written (by producer).
+	uint8_t head = 0;
+	/// Index of next operation to be executed (by consumer).
+	uint8_t tail = 0;
+
+	inline bool push(
+		const uint8_t kind, const uint8_t x, const uint8_t y,
+		const uint8_t a = 0, const uint8_t b = 0, const uint8_t value = 0,
+		const void* data = nullptr, const void* font = nullptr
+	) {
+		const uint8_t index = __atomic_load_n(&head, __ATOMIC_RELAXED);
+		const uint8_t next = (index + 1) & (size - 1);
+		if (next == __atomic_load_n(&tail, __ATOMIC_ACQUIRE)) {
+			return false;
+		}
+		operations[index] = { kind, x, y, a, b, value, data, font };
+		__atomic_store_n(&head, next, __ATOMIC_RELEASE);
+		return true;
+	}
+
+public:
+	/* Consumer */
+
+	/// Execute up to given number of queued operations on given display.
+	/// Returns number of executed operations.
+	template <class Display>
+	uint8_t execute(Display& display, uint8_t maxOperations = size)
+	{
+		uint8_t count = 0;
+		uint8_t index = __atomic_load_n(&tail, __ATOMIC_RELAXED);
+		while (count < maxOperations && index != __atomic_load_n(&head, __ATOMIC_ACQUIRE)) {
+			const RenderOperation operation = operations[index];
+			// Slot is free for producer once the operation is copied
+			index = (index + 1) & (size - 1);
+			__atomic_store_n(&tail, index, __ATOMIC_RELEASE);
+			operation.execute(display);
+			count++;
+		}
+		return count;
+	}
+
+	/// Check whether there are no queued operations.
+	inline bool empty() const
+	{
+		return __atomic_load_n(&head, __ATOMIC_ACQUIRE) == __atomic_load_n(&tail, __ATOMIC_ACQUIRE);
+	}
+
+	/* Producer */
+
+	inline bool clear(const uint8_t pattern)
+	{
+		return push(RenderOperation::Clear, 0, 0, 0, 0, pattern);
+	}
+	inline bool clearWhite()
+	{
+		return clear(0x00);
+	}
+	inline bool clearBlack()
+	{
+		return clear(0xFF);
+	}
+	inline bool clearGray()
+	{
+		return push(RenderOperation::ClearGray, 0, 0);
+	}
+
+	inline bool setPixel(const uint8_t x, const uint8_t y, const bool black = true)
+	{
+		return push(RenderOperation::Pixel, x, y, 0, 0, black);
+	}
+	inline bool clearPixel(const uint8_t x, const uint8_t y)
+	{
+		return setPixel(x, y, false);
+	}
+
+	inline bool drawHorizontalLine(const uint8_t x, const uint8_t y, const uint8_t length, const uint8_t pattern)
+	{
+		return push(RenderOperation::HorizontalLine, x, y, length, 0, pattern);
+	}
+	inline bool drawVerticalLine(const uint8_t x, const uint8_t y, const uint8_t length, const bool black)
+	{
+		return push(RenderOperation::VerticalLine, x, y, length, 0, black);
+	}
+	inline bool drawLine(const uint8_t x0, const uint8_t y0, const uint8_t x1, const uint8_t y1, const bool black)
+	{
+		return push(RenderOperation::Line, x0, y0, x1, y1, black);
+	}
+
+	inline bool drawRectangle(const uint8_t x, const uint8_t y, const uint8_t w, const uint8_t h, const bool black)
+	{
+		return push(RenderOperation::Rectangle, x, y, w, h, black);
+	}
+	inline bool drawFill(const uint8_t x, const uint8_t y, const uint8_t w, const uint8_t h, const bool black)
+	{
+		return push(RenderOperation::Fill, x, y, w, h, black);
+	}
+	inline bool drawGrayFill(const uint8_t x, const uint8_t y, const uint8_t w, const uint8_t h)
+	{
+		return push(RenderOperation::GrayFill, x, y, w, h);
+	}
+	inline bool drawPatternFill(const uint8_t x, const uint8_t y, const uint8_t w, const uint8_t h, const uint8_t* pattern)
+	{
+		return push(RenderOperation::PatternFill, x, y, w, h, 0, pattern);
+	}
+
+	inline bool drawTextVertical(const uint8_t x, const uint8_t y, const char* string, const void* font)
+	{
+		return push(RenderOperation::TextVertical, x, y, 0, 0, 0, string, font);
+	}
+};
+
+}
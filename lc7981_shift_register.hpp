@@ -0,0 +1,423 @@
+#pragma once
+
+#include <Arduino.h>
+#include <SPI.h>
+#include "lc7981.hpp"
+
+namespace LC7981
+{
+
+/// Bus driving the data bus (DB0..DB7) through 74HC595 shift register using
+/// hardware SPI (MOSI to SER, SCK to SRCLK, `LATCH` to RCLK), with data bits
+/// on Q0..Q7 (shifted MSB first). Saves most of pins used by `PinsBus`.
+///
+/// Control lines (EN, RS, RW, CS) can be either pins of the microcontroller,
+/// or outputs of second 74HC595 chained after the first one (Q7' of data
+/// register to SER of control register), if `controlShifted` is set. Then
+/// the `EN`, `RS`, `RW` and `CS` are bit numbers of the control register.
+///
+/// During bursts (with control lines as pins), next byte is shifted while EN
+/// is strobed for current byte, as 74HC595 keeps outputs until latched.
+/// With control lines shifted, each byte takes two frames (EN high and low).
+///
+/// Reading requires 74HC165 (parallel inputs connected to DB0..DB7, Q7 to
+/// MISO not shared with other devices, CE to ground, PL to `LOAD` pin) and
+/// `OE` pin connected to output enable of the data register (only), to 
+/// release the data bus when reading.
+/// If `LOAD` is `NOT_A_PIN`, reading is disabled (`canRead` is false) and
+/// reads return 0, so partial bytes are changed by bit operations instead 
+/// (see `readCost`), or shadow memory can be used (see `ShadowMemory`).
+template <
+	// Storage register clock (RCLK) of 74HC595 (both, if control shifted)
+	uint8_t LATCH,
+	// Enable: HIGH -> LOW enables
+	uint8_t EN,
+	// Register select: HIGH - instruction, LOW - data
+	uint8_t RS,
+	// Read/write: HIGH - read, LOW - write. Can be `NOT_A_PIN` if reading is
+	// disabled (display RW pin connected to ground).
+	uint8_t RW = NOT_A_PIN,
+	// Chip select: LOW - selected. Can be `NOT_A_PIN` if always selected.
+	uint8_t CS = NOT_A_PIN,
+	// Whether control lines are outputs of second 74HC595 (bit numbers).
+	bool controlShifted = false,
+	// Output enable of data 74HC595 (LOW - enabled), required for reading.
+	uint8_t OE = NOT_A_PIN,
+	// Parallel load of 74HC165 (LOW - load), `NOT_A_PIN` disables reading.
+	uint8_t LOAD = NOT_A_PIN,
+	// SPI clock frequency
+	uint32_t clock = 8000000,
+	// Pins IO implementation, see `ArduinoIO` and `FastIO`.
+	class IO = ArduinoIO
+>
+class ShiftRegisterBus : public BusBase<ShiftRegisterBus<
+	LATCH, EN, RS, RW, CS, controlShifted, OE, LOAD, clock, IO
+>>
+{
+	static_assert(LOAD == NOT_A_PIN || (OE != NOT_A_PIN && RW != NOT_A_PIN),
+		"Reading requires OE and RW to be connected.");
+
+public:
+	/// Whether the bus can read from the display.
+	static constexpr bool canRead = LOAD != NOT_A_PIN;
+	/// Without reading, partial bytes are changed by bit operations only.
+	static constexpr uint8_t readCost = canRead ? 2 : 255;
+
+protected:
+	template <uint8_t pin>
+	using Pin = typename IO::template Pin<pin>;
+
+	/// Value of control register for given register, direction and EN.
+	static constexpr uint8_t control(const register_t reg, const bool read, const bool enable)
+	{
+		// CS (if used) is low, so selected.
+		return (reg ? 1 << (RS & 7) : 0)
+			| (read && RW != NOT_A_PIN ? 1 << (RW & 7) : 0)
+			| (enable ? 1 << (EN & 7) : 0);
+	}
+
+	/// Control register value when idle (chip deselected).
+	static constexpr uint8_t idleControl = CS != NOT_A_PIN ? 1 << (CS & 7) : 0;
+
+	/// Flag for burst of data writes, while chip is kept selected and
+	/// control lines are kept set (and SPI transaction is kept open).
+	bool inWriteBurst = false;
+
+	/// Start shifting byte out. On AVR it doesn't wait for the transfer, so
+	/// it can overlap with other work, until `shiftWait` is called.
+	inline void shiftStart(const uint8_t value)
+	{
+#ifdef SPDR
+		SPDR = value;
+#else
+		received = SPI.transfer(value);
+#endif
+	}
+
+	/// Wait for shifting to finish, returning byte shifted in (from MISO).
+	inline uint8_t shiftWait()
+	{
+#ifdef SPDR
+		while (!(SPSR & _BV(SPIF)));
+		return SPDR;
+#else
+		return received;
+#endif
+	}
+
+#ifndef SPDR
+	uint8_t received;
+#endif
+
+	/// Copy shift register(s) to outputs.
+	inline void latch()
+	{
+		Pin<LATCH>::write(HIGH);
+		Pin<LATCH>::write(LOW);
+	}
+
+	/// Shift and latch data byte, with control byte if control shifted.
+	/// Returns byte shifted in (from 74HC165, if used).
+	inline uint8_t shiftFrame(const uint8_t controlValue, const uint8_t data)
+	{
+		uint8_t in = 0;
+		if (controlShifted) {
+			shiftStart(controlValue);
+			in = shiftWait();
+		}
+		shiftStart(data);
+		const uint8_t last = shiftWait();
+		latch();
+		return controlShifted ? in : last;
+	}
+
+	inline void beginTransaction()
+	{
+		SPI.beginTransaction(SPISettings(clock, MSBFIRST, SPI_MODE0));
+	}
+
+	inline void endTransaction()
+	{
+		SPI.endTransaction();
+	}
+
+	/// Select chip and set control lines (as pins) for writing to register.
+	inline void setupWrite(const register_t reg)
+	{
+		Pin<EN>::write(LOW);
+		if (CS != NOT_A_PIN) {
+			Pin<CS>::write(LOW);
+		}
+		if (RW != NOT_A_PIN) {
+			Pin<RW>::write(LOW);
+		}
+		Pin<RS>::write(reg);
+		if (OE != NOT_A_PIN) {
+			Pin<OE>::write(LOW);
+		}
+	}
+
+	/// Deselect chip (control lines as pins).
+	inline void deselectChip()
+	{
+		if (CS != NOT_A_PIN) {
+			Pin<CS>::write(HIGH);
+		}
+	}
+
+	/// Strobe EN (as pin), assuming data and control lines are set.
+	inline void strobeWrite()
+	{
+		delayNanoseconds<90, IO::pinWriteCycles>();
+		Pin<EN>::write(HIGH);
+		delayNanoseconds<220, IO::pinWriteCycles>();
+		Pin<EN>::write(LOW);
+	}
+
+	/// Write byte using shifted control lines: EN high, then EN low frame.
+	inline void writeShifted(const register_t reg, const uint8_t value)
+	{
+		shiftFrame(control(reg, false, true), value);
+		delayNanoseconds<220>();
+		shiftFrame(control(reg, false, false), value);
+	}
+
+public:
+	void write(const register_t reg, const uint8_t value)
+	{
+		if (inWriteBurst) {
+			writeBytes(&value, 1);
+			return;
+		}
+
+		beginTransaction();
+		if (controlShifted) {
+			if (OE != NOT_A_PIN) {
+				Pin<OE>::write(LOW);
+			}
+			shiftFrame(control(reg, false, false), value);
+			writeShifted(reg, value);
+			shiftFrame(idleControl, value);
+		}
+		else {
+			shiftFrame(0, value);
+			setupWrite(reg);
+			strobeWrite();
+			deselectChip();
+		}
+		endTransaction();
+	}
+
+	void writeRegister(const uint8_t instruction, const uint8_t value)
+	{
+		beginTransaction();
+		if (controlShifted) {
+			if (OE != NOT_A_PIN) {
+				Pin<OE>::write(LOW);
+			}
+			shiftFrame(control(Command, false, false), instruction);
+			writeShifted(Command, instruction);
+			// Register select changes while EN is low
+			shiftFrame(control(Data, false, false), value);
+			writeShifted(Data, value);
+			shiftFrame(idleControl, value);
+		}
+		else {
+			shiftFrame(0, instruction);
+			setupWrite(Command);
+			// Shift parameter while strobing the instruction
+			shiftStart(value);
+			strobeWrite();
+			shiftWait();
+			latch();
+			Pin<RS>::write(Data);
+			strobeWrite();
+			deselectChip();
+		}
+		endTransaction();
+	}
+
+	uint8_t read(const register_t reg)
+	{
+		if (!canRead) {
+			return 0;
+		}
+
+		beginTransaction();
+		// Release data bus before the display starts driving it
+		Pin<OE>::write(HIGH);
+		if (controlShifted) {
+			shiftFrame(control(reg, true, false), 0);
+			delayNanoseconds<90>();
+			shiftFrame(control(reg, true, true), 0);
+		}
+		else {
+			Pin<EN>::write(LOW);
+			if (CS != NOT_A_PIN) {
+				Pin<CS>::write(LOW);
+			}
+			Pin<RW>::write(HIGH);
+			Pin<RS>::write(reg);
+			delayNanoseconds<90, IO::pinWriteCycles>();
+			Pin<EN>::write(HIGH);
+		}
+		delayNanoseconds<140, IO::pinWriteCycles>();
+
+		// Capture data bus into 74HC165
+		Pin<LOAD>::write(LOW);
+		Pin<LOAD>::write(HIGH);
+
+		uint8_t out;
+		if (controlShifted) {
+			// Captured byte is shifted in while EN goes low
+			out = shiftFrame(control(reg, true, false), 0);
+			shiftFrame(idleControl, 0);
+		}
+		else {
+			Pin<EN>::write(LOW);
+			deselectChip();
+			shiftStart(0);
+			out = shiftWait();
+		}
+		endTransaction();
+		return out;
+	}
+
+	void writeBytes(const uint8_t* data, uint16_t length)
+	{
+		if (!length) return;
+		if (!inWriteBurst) {
+			beginWriteBurst();
+			writeBytes(data, length);
+			endWriteBurst();
+			return;
+		}
+
+		if (controlShifted) {
+			while (length--) {
+				writeShifted(Data, *data++);
+			}
+			return;
+		}
+
+		shiftStart(*data++);
+		shiftWait();
+		latch();
+		while (--length) {
+			// Shift next byte while strobing the current one
+			shiftStart(*data++);
+			strobeWrite();
+			shiftWait();
+			latch();
+		}
+		strobeWrite();
+	}
+
+	void writeRepeat(const uint8_t value, uint16_t count)
+	{
+		if (!count) return;
+		if (!inWriteBurst) {
+			beginWriteBurst();
+			writeRepeat(value, count);
+			endWriteBurst();
+			return;
+		}
+
+		if (controlShifted) {
+			while (count--) {
+				writeShifted(Data, value);
+			}
+			return;
+		}
+
+		// Outputs stay the same, so only EN needs to be strobed.
+		shiftFrame(0, value);
+		while (count--) {
+			strobeWrite();
+		}
+	}
+
+	void beginWriteBurst()
+	{
+		beginTransaction();
+		if (controlShifted) {
+			if (OE != NOT_A_PIN) {
+				Pin<OE>::write(LOW);
+			}
+			shiftFrame(control(Data, false, false), 0);
+		}
+		else {
+			setupWrite(Data);
+		}
+		inWriteBurst = true;
+	}
+
+	void endWriteBurst()
+	{
+		if (!inWriteBurst) return;
+		inWriteBurst = false;
+		if (controlShifted) {
+			shiftFrame(idleControl, 0);
+		}
+		else {
+			deselectChip();
+		}
+		endTransaction();
+	}
+
+	void init()
+	{
+		Pin<LATCH>::output();
+		Pin<LATCH>::write(LOW);
+
+		if (OE != NOT_A_PIN) {
+			Pin<OE>::output();
+			Pin<OE>::write(LOW);
+		}
+
+		if (LOAD != NOT_A_PIN) {
+			Pin<LOAD>::output();
+			Pin<LOAD>::write(HIGH);
+		}
+
+		SPI.begin();
+
+		if (controlShifted) {
+			beginTransaction();
+			shiftFrame(idleControl, 0);
+			endTransaction();
+		}
+		else {
+			Pin<EN>::output();
+			Pin<EN>::write(LOW);
+			Pin<RS>::output();
+			if (RW != NOT_A_PIN) {
+				Pin<RW>::output();
+				Pin<RW>::write(LOW);
+			}
+			if (CS != NOT_A_PIN) {
+				Pin<CS>::output();
+				Pin<CS>::write(HIGH);
+			}
+		}
+	}
+};
+
+/// Display class using shift register bus, see `ShiftRegisterBus` for
+/// details about the template parameters. Without reading (`LOAD` not set),
+/// consider `ShadowMemory` as `Memory`, if there is enough RAM, to avoid
+/// changing partial bytes bit by bit.
+template <
+	uint8_t LATCH, uint8_t EN, uint8_t RS,
+	uint8_t RW = NOT_A_PIN, uint8_t CS = NOT_A_PIN,
+	bool controlShifted = false,
+	uint8_t OE = NOT_A_PIN, uint8_t LOAD = NOT_A_PIN,
+	uint32_t clock = 8000000,
+	class IO = ArduinoIO,
+	class Memory = NoShadowMemory
+>
+using ShiftRegisterDisplay = BasicDisplay<ShiftRegisterBus<
+	LATCH, EN, RS, RW, CS, controlShifted, OE, LOAD, clock, IO
+>, Memory>;
+
+}
@@ -0,0 +1,343 @@
+#pragma once
+
+#include <Arduino.h>
+#include "lc7981.hpp"
+
+namespace LC7981
+{
+
+/// Canvas spanning multiple displays placed side by side (like 480x128 or
+/// 720x128), sharing the bus as `SharedDisplay` (first chip select is the
+/// leftmost display). Provides the same drawing API as the displays, with
+/// horizontal coordinates and sizes as `uint16_t`. Primitives are split at
+/// displays boundaries, and each piece is drawn on its display in one go,
+/// so horizontal line across all displays costs single cursor set for each.
+/// Clearing is broadcast to all displays at once.
+template <class Display, uint8_t panelWidth = 240>
+class WideCanvas
+{
+	static_assert(panelWidth % 8 == 0, "Panel width needs to be multiple of 8.");
+
+public:
+	Display display;
+
+	/// Number of displays.
+	static constexpr uint8_t panels = Display::count;
+
+	const uint16_t width;
+	const uint8_t height;
+
+	/// Constructor
+	WideCanvas(uint8_t height = 128)
+		: display(panelWidth, height), width(panelWidth * panels), height(height)
+	{}
+
+	/// Prepare all displays to use graphical mode.
+	void initGraphicMode()
+	{
+		display.selectAll();
+		display.initGraphicMode();
+	}
+
+protected:
+	/// Call given function (with display-local x and length) for each part
+	/// of horizontal span, selecting the display for it.
+	template <typename Function>
+	void forEachPanel(const uint16_t x, uint16_t length, Function function)
+	{
+		uint8_t panel = x / panelWidth;
+		uint8_t localX = x % panelWidth;
+		while (length && panel < panels) {
+			const uint8_t part = length < panelWidth - localX ? length : panelWidth - localX;
+			display.selectOnly(panel);
+			function(localX, part);
+			length -= part;
+			localX = 0;
+			panel += 1;
+		}
+	}
+
+	/// Select display containing given x, returning display-local x.
+	inline uint8_t selectPanel(const uint16_t x)
+	{
+		display.selectOnly(x / panelWidth);
+		return x % panelWidth;
+	}
+
+
+
+	/* Basic drawing */
+public:
+	/// Clear all displays using specified pattern.
+	void clear(const uint8_t pattern)
+	{
+		display.selectAll();
+		display.clear(pattern);
+	}
+	/// Clear all displays white (empty).
+	inline void clearWhite()
+	{
+		clear(0);
+	}
+	/// Clear all displays black (filled).
+	inline void clearBlack()
+	{
+		clear(0b11111111);
+	}
+	/// Clear all displays gray (alternating bits pattern).
+	void clearGray()
+	{
+		display.selectAll();
+		display.clearGray();
+	}
+
+	/// Set single bit at given coordinates.
+	inline void setPixel(const uint16_t x, const uint8_t y)
+	{
+		display.setPixel(selectPanel(x), y);
+	}
+	/// Clear single bit at given coordinates.
+	inline void clearPixel(const uint16_t x, const uint8_t y)
+	{
+		display.clearPixel(selectPanel(x), y);
+	}
+	/// Set or clear single bit at given coordinates depending on requested value.
+	inline void setPixel(const uint16_t x, const uint8_t y, const bool black)
+	{
+		display.setPixel(selectPanel(x), y, black);
+	}
+
+	/// Draw horizontal line from specified point of specified length using specified pattern.
+	void drawHorizontalLine(const uint16_t x, const uint8_t y, const uint16_t length, const uint8_t pattern)
+	{
+		forEachPanel(x, length, [&](const uint8_t localX, const uint8_t part) {
+			display.drawHorizontalLine(localX, y, part, pattern);
+		});
+	}
+	/// Draw black horizontal line from specified point of specified length.
+	inline void drawBlackHorizontalLine(const uint16_t x, const uint8_t y, const uint16_t length)
+	{
+		drawHorizontalLine(x, y, length, 0b11111111);
+	}
+	/// Draw white horizontal line from specified point of specified length.
+	inline void drawWhiteHorizontalLine(const uint16_t x, const uint8_t y, const uint16_t length)
+	{
+		drawHorizontalLine(x, y, length, 0b00000000);
+	}
+
+	/// Draw black vertical line from specified point of specified length.
+	void drawBlackVerticalLine(const uint16_t x, const uint8_t y, const uint8_t length)
+	{
+		display.drawBlackVerticalLine(selectPanel(x), y, length);
+	}
+	/// Draw white vertical line from specified point of specified length.
+	void drawWhiteVerticalLine(const uint16_t x, const uint8_t y, const uint8_t length)
+	{
+		display.drawWhiteVerticalLine(selectPanel(x), y, length);
+	}
+
+	/// Draw line from specified point of specified length using white or black.
+	void drawLine(uint16_t x0, uint8_t y0, uint16_t x1, uint8_t y1, const bool black)
+	{
+		if (x0 > x1) {
+			return drawLine(x1, y1, x0, y0, black);
+		}
+
+		uint8_t panel = x0 / panelWidth;
+		const uint16_t offset = panel * panelWidth;
+		if (x1 < offset + panelWidth) {
+			display.selectOnly(panel);
+			return display.drawLine(x0 - offset, y0, x1 - offset, y1, black);
+		}
+		if (y0 == y1) {
+			return drawHorizontalLine(x0, y0, x1 - x0 + 1, black ? 0b11111111 : 0);
+		}
+
+		// Line crossing displays boundaries, pixel by pixel as on display
+		const int16_t dx = x1 - x0;
+		const int16_t dy = y1 > y0 ? y1 - y0 : y0 - y1;
+		const int8_t stepY = y1 > y0 ? 1 : -1;
+		uint8_t localX = x0 - offset;
+		int16_t err = dx - dy;
+		display.selectOnly(panel);
+		while (true) {
+			display.setPixel(localX, y0, black);
+			if (x0 == x1 && y0 == y1) {
+				break;
+			}
+
+			const int16_t e2 = 2 * err;
+			if (-e2 <= dy) {
+				err -= dy;
+				x0 += 1;
+				localX += 1;
+				if (localX == panelWidth) {
+					localX = 0;
+					panel += 1;
+					display.selectOnly(panel);
+				}
+			}
+			if (e2 <= dx) {
+				err += dx;
+				y0 += stepY;
+			}
+		}
+	}
+	/// Draw black line from specified point of specified length.
+	inline void drawBlackLine(const uint16_t x0, const uint8_t y0, const uint16_t x1, const uint8_t y1)
+	{
+		drawLine(x0, y0, x1, y1, true);
+	}
+	/// Draw white line from specified point of specified length.
+	inline void drawWhiteLine(const uint16_t x0, const uint8_t y0, const uint16_t x1, const uint8_t y1)
+	{
+		drawLine(x0, y0, x1, y1, false);
+	}
+
+
+
+	/* Basic shapes */
+public:
+	/// Draw black rectangle on give point with given size.
+	void drawBlackRectangle(const uint16_t x, const uint8_t y, const uint16_t w, const uint8_t h)
+	{
+		drawBlackHorizontalLine(x, y, w);
+		drawBlackHorizontalLine(x, y + h - 1, w);
+		drawBlackVerticalLine(x, y + 1, h - 2);
+		drawBlackVerticalLine(x + w - 1, y + 1, h - 2);
+	}
+	/// Draw white rectangle on give point with given size.
+	void drawWhiteRectangle(const uint16_t x, const uint8_t y, const uint16_t w, const uint8_t h)
+	{
+		drawWhiteHorizontalLine(x, y, w);
+		drawWhiteHorizontalLine(x, y + h - 1, w);
+		drawWhiteVerticalLine(x, y + 1, h - 2);
+		drawWhiteVerticalLine(x + w - 1, y + 1, h - 2);
+	}
+
+	/// Draw filled black rectangle on give point with given size.
+	void drawBlackFill(const uint16_t x, const uint8_t y, const uint16_t w, const uint8_t h)
+	{
+		forEachPanel(x, w, [&](const uint8_t localX, const uint8_t part) {
+			display.drawBlackFill(localX, y, part, h);
+		});
+	}
+	/// Draw filled white rectangle on give point with given size.
+	void drawWhiteFill(const uint16_t x, const uint8_t y, const uint16_t w, const uint8_t h)
+	{
+		forEachPanel(x, w, [&](const uint8_t localX, const uint8_t part) {
+			display.drawWhiteFill(localX, y, part, h);
+		});
+	}
+	/// Draw filled gray rectangle on give point with given size.
+	void drawGrayFill(const uint16_t x, const uint8_t y, const uint16_t w, const uint8_t h)
+	{
+		forEachPanel(x, w, [&](const uint8_t localX, const uint8_t part) {
+			display.drawGrayFill(localX, y, part, h);
+		});
+	}
+
+	/// Draw custom pattern filling rectangle from given point with given size.
+	/// See `BasicDisplay::drawPatternFill` for the pattern format.
+	void drawPatternFill(const uint16_t x, const uint8_t y, const uint16_t w, const uint8_t h, const uint8_t* pattern)
+	{
+		forEachPanel(x, w, [&](const uint8_t localX, const uint8_t part) {
+			display.drawPatternFill(localX, y, part, h, pattern);
+		});
+	}
+
+
+
+	/* Text */
+protected:
+	/// Get up to 8 bits of font data, starting at given bit of char data.
+	static inline uint8_t fontBits(const uint8_t* charData, const uint16_t bit, const uint8_t count)
+	{
+		const uint8_t shift = bit % 8;
+		uint8_t bits = pgm_read_byte(charData + bit / 8) >> shift;
+		if (shift + count > 8) {
+			bits |= pgm_read_byte(charData + bit / 8 + 1) << (8 - shift);
+		}
+		return bits & ~(0b11111111 << count);
+	}
+
+	/// Put up to 8 bits into row buffer at given bit position.
+	static inline void putBits(uint8_t* row, const uint16_t position, const uint8_t bits)
+	{
+		const uint8_t shift = position % 8;
+		row[position / 8] |= bits << shift;
+		if (shift) {
+			row[position / 8 + 1] |= bits >> (8 - shift);
+		}
+	}
+
+public:
+	/// Draw text vertically using selected font. Text crossing displays
+	/// boundaries is composed row by row in buffer, drawn in parts on the
+	/// displays (each selected once for all rows of its part), keeping 
+	/// background around the text. Text is clipped at
+	/// right edge of the canvas.
+	void drawTextVertical(const uint16_t x, uint8_t y, const char* string, const void* font)
+	{
+		const auto fontWidth  = static_cast<const font_header_t*>(font)->width;
+		const auto fontHeight = static_cast<const font_header_t*>(font)->height;
+		if (x >= width) return;
+		const uint16_t textWidth = strlen(string) * fontWidth;
+		if (!textWidth) return;
+		const uint16_t visibleWidth = textWidth < width - x ? textWidth : width - x;
+		const uint16_t end = x + visibleWidth - 1;
+		if (visibleWidth == textWidth && x / panelWidth == end / panelWidth) {
+			display.drawTextVertical(selectPanel(x), y, string, font);
+			return;
+		}
+
+		const uint8_t* fontData = static_cast<const uint8_t*>(font) + sizeof(font_header_t);
+		// Narrow fonts rows are padded to bytes, wide ones are connected
+		const uint8_t rowBits = fontWidth <= 8 ? 8 : fontWidth;
+		const uint16_t charBytes = (rowBits * fontHeight + 7) / 8;
+		const uint8_t bitsOffset = x % 8;
+		const uint8_t firstColumn = x / 8;
+		const uint8_t length = end / 8 - firstColumn + 1;
+		const uint8_t firstMask = 0b11111111 << bitsOffset;
+		const uint8_t lastMask = 0b11111111 >> (7 - end % 8);
+		// Bit position in the row buffer, where clipped text ends
+		const uint16_t limit = bitsOffset + visibleWidth;
+		uint8_t row[panelWidth / 8 * panels + 1];
+		// Each display is selected once, drawing all rows of its part
+		uint8_t column = firstColumn;
+		while (column < firstColumn + length) {
+			const uint8_t panel = column / (panelWidth / 8);
+			if (panel >= panels) break;
+			const uint8_t localColumn = column % (panelWidth / 8);
+			const uint8_t remaining = firstColumn + length - column;
+			const uint8_t part = remaining < panelWidth / 8 - localColumn ? remaining : panelWidth / 8 - localColumn;
+			const uint8_t offset = column - firstColumn;
+			const uint8_t partFirstMask = column == firstColumn ? firstMask : 0b11111111;
+			const uint8_t partLastMask = column + part == firstColumn + length ? lastMask : 0b11111111;
+			// Only characters overlapping the part are composed
+			const uint16_t partBegin = offset * 8;
+			const uint16_t partLimit = partBegin + part * 8 < limit ? partBegin + part * 8 : limit;
+			const uint16_t firstChar = partBegin > bitsOffset ? (partBegin - bitsOffset) / fontWidth : 0;
+			display.selectOnly(panel);
+			for (uint8_t r = 0; r < fontHeight; r++) {
+				memset(row + offset, 0, part + 1);
+				uint16_t position = bitsOffset + firstChar * fontWidth;
+				for (const char* pointer = string + firstChar; *pointer && position < partLimit; pointer++) {
+					const uint8_t* charData = fontData + (*pointer - ' ') * charBytes;
+					for (uint8_t k = 0; k < fontWidth && position + k < limit; k += 8) {
+						uint8_t count = fontWidth - k < 8 ? fontWidth - k : 8;
+						if (count > limit - (position + k)) {
+							count = limit - (position + k);
+						}
+						putBits(row, position + k, fontBits(charData, r * rowBits + k, count));
+					}
+					position += fontWidth;
+				}
+				display.drawMaskedRow(localColumn, y + r, row + offset, part, partFirstMask, partLastMask);
+			}
+			column += part;
+		}
+	}
+};
+
+}
@@ -0,0 +1,273 @@
+#pragma once
+
+#include <Arduino.h>
+#include "lc7981.hpp"
+
+namespace LC7981
+{
+
+/// Write-combining stage for scattered pixel drawing (pixels, lines,
+/// outlines) on given display. Pending writes are kept as bits to set and
+/// clear for each byte address, sorted by address, so pixels falling into
+/// the same byte are merged, and consecutive bytes are written as single
+/// burst. Writes are emitted when the buffer is full, on `flushWrites` or
+/// when the combiner goes out of scope. Flush before drawing or reading on
+/// the display directly, as pending writes would be applied after it.
+/// Entries take 4 bytes each.
+template <class Display, uint8_t size = 16>
+class WriteCombiner
+{
+	static_assert(size >= 1, "Write combiner needs at least one entry.");
+
+public:
+	Display& display;
+
+protected:
+	struct Entry
+	{
+		uint16_t address;
+		uint8_t setBits;
+		uint8_t clearBits;
+	};
+
+	/// Pending writes, sorted by address.
+	Entry entries[size];
+	uint8_t count = 0;
+
+public:
+	/// Constructor
+	WriteCombiner(Display& display)
+		: display(display)
+	{}
+
+	~WriteCombiner()
+	{
+		flushWrites();
+	}
+
+	/// Queue setting and clearing given bits of byte at given address.
+	void writeBits(const uint16_t address, const uint8_t setBits, const uint8_t clearBits)
+	{
+		if (!(setBits | clearBits)) return;
+		uint8_t i = count;
+		while (i > 0 && entries[i - 1].address > address) {
+			i--;
+		}
+		if (i > 0 && entries[i - 1].address == address) {
+			Entry& entry = entries[i - 1];
+			entry.setBits = (entry.setBits & ~clearBits) | setBits;
+			entry.clearBits = (entry.clearBits & ~setBits) | clearBits;
+			return;
+		}
+		if (count == size) {
+			flushWrites();
+			i = 0;
+		}
+		memmove(entries + i + 1, entries + i, (count - i) * sizeof(Entry));
+		entries[i] = { address, setBits, clearBits };
+		count += 1;
+	}
+	/// Queue writing whole byte at given address.
+	inline void writeByte(const uint16_t address, const uint8_t value)
+	{
+		writeBits(address, value, ~value);
+	}
+
+	/// Write pending writes to the display. Runs of consecutive bytes are
+	/// written as single burst (read first as single burst if some of the
+	/// bytes are changed only partially in more than single bit), single
+	/// bits are changed by bit operations. If the display can't read (see
+	/// `bitOperationsLimit`), partial bytes are always changed by bit 
+	/// operations.
+	void flushWrites()
+	{
+		uint8_t start = 0;
+		while (start < count) {
+			uint8_t end = start + 1;
+			bool needRead = canRead && !isSingleBit(entries[start]);
+			while (end < count && entries[end].address == entries[end - 1].address + 1) {
+				needRead |= canRead && !isSingleBit(entries[end]);
+				end++;
+			}
+			if (needRead) {
+				writeRunRead(start, end);
+			}
+			else {
+				writeRunBits(start, end);
+			}
+			start = end;
+		}
+		display.writeEnd();
+		count = 0;
+	}
+
+protected:
+	/// Whether the display reads partial bytes, rather than changing them
+	/// by bit operations even when most of the bits change (like buses not
+	/// wired for reading do).
+	static constexpr bool canRead = Display::bitOperationsLimit < 8;
+
+	/// Check whether entry changes single bit only, or whole byte.
+	static inline bool isSingleBit(const Entry& entry)
+	{
+		const uint8_t bits = entry.setBits | entry.clearBits;
+		return bits == 0b11111111 || (bits & (bits - 1)) == 0;
+	}
+
+	/// Write run of entries, reading the bytes first as single burst (or
+	/// from shadow copy, if the display has it).
+	void writeRunRead(const uint8_t start, const uint8_t end)
+	{
+		uint8_t data[size];
+		const uint8_t length = end - start;
+		if (Display::shadowed) {
+			for (uint8_t i = 0; i < length; i++) {
+				display.setCursorAddress(entries[start].address + i);
+				data[i] = display.readSingleByte();
+			}
+		}
+		else {
+			display.setCursorAddress(entries[start].address);
+			display.readStart();
+			display.readNextBytes(data, length);
+		}
+		display.setCursorAddress(entries[start].address);
+		display.writeStart();
+		for (uint8_t i = 0; i < length; i++) {
+			const Entry& entry = entries[start + i];
+			display.writeNextByte((data[i] & ~entry.clearBits) | entry.setBits);
+		}
+		display.writeEnd();
+	}
+
+	/// Write run of entries with whole bytes written in bursts and partial
+	/// bytes by bit operations (for each changed bit).
+	void writeRunBits(const uint8_t start, const uint8_t end)
+	{
+		bool bursting = false;
+		for (uint8_t i = start; i < end; i++) {
+			const Entry& entry = entries[i];
+			if ((entry.setBits | entry.clearBits) == 0b11111111) {
+				if (!bursting) {
+					display.setCursorAddress(entry.address);
+					display.writeStart();
+					bursting = true;
+				}
+				display.writeNextByte(entry.setBits);
+			}
+			else {
+				bursting = false;
+				const uint8_t bits = entry.setBits | entry.clearBits;
+				for (uint8_t which = 0; which < 8; which++) {
+					if (bits & (1 << which)) {
+						display.setCursorAddress(entry.address);
+						display.setDataBit(which, entry.setBits & (1 << which));
+					}
+				}
+			}
+		}
+		display.writeEnd();
+	}
+
+
+
+	/* Drawing */
+public:
+	/// Set single bit at given coordinates.
+	inline void setPixel(const uint8_t x, const uint8_t y)
+	{
+		setPixel(x, y, true);
+	}
+	/// Clear single bit at given coordinates.
+	inline void clearPixel(const uint8_t x, const uint8_t y)
+	{
+		setPixel(x, y, false);
+	}
+	/// Set or clear single bit at given coordinates depending on requested value.
+	inline void setPixel(const uint8_t x, const uint8_t y, const bool black)
+	{
+		const uint8_t bit = 1 << (x % 8);
+		writeBits(display.width / 8 * y + x / 8, black ? bit : 0, black ? 0 : bit);
+	}
+
+	/// Draw horizontal line from specified point of specified length using specified pattern.
+	void drawHorizontalLine(const uint8_t x, const uint8_t y, const uint8_t length, const uint8_t pattern)
+	{
+		if (!length) return;
+		const uint16_t rowAddress = display.width / 8 * y;
+		const uint8_t last = x + length - 1;
+		for (uint8_t column = x / 8; column <= last / 8; column++) {
+			uint8_t mask = 0b11111111;
+			if (column == x / 8) {
+				mask &= 0b11111111 << (x % 8);
+			}
+			if (column == last / 8) {
+				mask &= 0b11111111 >> (7 - last % 8);
+			}
+			writeBits(rowAddress + column, pattern & mask, ~pattern & mask);
+		}
+	}
+
+	/// Draw black vertical line from specified point of specified length.
+	void drawBlackVerticalLine(const uint8_t x, const uint8_t y, const uint8_t length)
+	{
+		for (uint8_t i = y; i < y + length; i++) {
+			setPixel(x, i, true);
+		}
+	}
+	/// Draw white vertical line from specified point of specified length.
+	void drawWhiteVerticalLine(const uint8_t x, const uint8_t y, const uint8_t length)
+	{
+		for (uint8_t i = y; i < y + length; i++) {
+			setPixel(x, i, false);
+		}
+	}
+
+	/// Draw line from specified point of specified length using white or black.
+	void drawLine(uint8_t x0, uint8_t y0, const uint8_t x1, const uint8_t y1, const bool black)
+	{
+		if (x0 > x1) {
+			return drawLine(x1, y1, x0, y0, black);
+		}
+
+		const int16_t dx = x1 - x0;
+		const int16_t dy = y1 > y0 ? y1 - y0 : y0 - y1;
+		const int8_t stepY = y1 > y0 ? 1 : -1;
+		int16_t err = dx - dy;
+		while (true) {
+			setPixel(x0, y0, black);
+			if (x0 == x1 && y0 == y1) {
+				break;
+			}
+
+			const int16_t e2 = 2 * err;
+			if (-e2 <= dy) {
+				err -= dy;
+				x0 += 1;
+			}
+			if (e2 <= dx) {
+				err += dx;
+				y0 += stepY;
+			}
+		}
+	}
+
+	/// Draw black rectangle on give point with given size.
+	void drawBlackRectangle(const uint8_t x, const uint8_t y, const uint8_t w, const uint8_t h)
+	{
+		drawHorizontalLine(x, y, w, 0b11111111);
+		drawHorizontalLine(x, y + h - 1, w, 0b11111111);
+		drawBlackVerticalLine(x, y + 1, h - 2);
+		drawBlackVerticalLine(x + w - 1, y + 1, h - 2);
+	}
+	/// Draw white rectangle on give point with given size.
+	void drawWhiteRectangle(const uint8_t x, const uint8_t y, const uint8_t w, const uint8_t h)
+	{
+		drawHorizontalLine(x, y, w, 0);
+		drawHorizontalLine(x, y + h - 1, w, 0);
+		drawWhiteVerticalLine(x, y + 1, h - 2);
+		drawWhiteVerticalLine(x + w - 1, y + 1, h - 2);
+	}
+};
+
+}